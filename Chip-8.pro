@@ -18,11 +18,13 @@ QMAKE_CXXFLAGS += -std=c++14
 
 SOURCES += main.cpp \
     Chip8.cpp \
+    Compositor.cpp \
     mainwindow.cpp \
     game.cpp
 
 HEADERS += \
     Chip8.hpp \
+    Compositor.hpp \
     mainwindow.hpp \
     game.hpp
 
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <limits>
 #include <fstream>
+#include <stdexcept>
 
 #include "Chip8.hpp"
 
@@ -43,19 +44,16 @@ void Chip8::loadGame(const std::string& filePath) {
     std::ifstream ifs(filePath, std::ios_base::in | std::ios_base::binary);
     if (!ifs.good())
         throw std::runtime_error("File does not exist");
-    ifs.seekg(std::ios_base::end);
-    auto size = ifs.tellg();
 
-    if (size >= (0xFFF - 0x200) * std::numeric_limits<uint8_t>::max())
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    loadGame(rom);
+}
+
+void Chip8::loadGame(const std::vector<uint8_t>& rom) {
+    if (rom.size() > memory.size() - 0x200)
         throw std::runtime_error("File is bigger than accpetable CHIP-8 memory range");
-    else ifs.seekg(std::ios_base::beg);
-    std::cout << std::boolalpha;
-    std::cout << std::hex;
 
-    uint8_t opcode;
-    for (size_t i = 0; ifs.read(reinterpret_cast<char*>(&opcode), sizeof(uint8_t)) ; i++) {
-        memory[i + 0x200] = opcode;
-    }
+    std::copy(rom.cbegin(), rom.cend(), memory.begin() + 0x200);
 }
 
 void Chip8::removeDrawFlag() noexcept {
@@ -67,8 +65,11 @@ void Chip8::removeDrawFlag() noexcept {
 // 3. Executve opcode
 // 4. Update timers
 void Chip8::emulateCycle() {
-    std::cerr << std::hex;
+    // an opcode at 0xFFF would be fetched past the end of memory
+    if (programCounter > 0xFFE)
+        throw std::out_of_range("Program counter is outside of memory");
     uint16_t opcode = static_cast<uint16_t>(memory[programCounter] << 8 | memory[programCounter + 1]);
+    currentOpcode = opcode;
     switch(opcode & 0xF000) { // get the leftmost bit
     case 0x0000:
         switch(opcode & 0x00FF) {
@@ -80,11 +81,13 @@ void Chip8::emulateCycle() {
             programCounter += 2;
             break;
         case 0x00EE : // 00EE : return from subroutine
+            if (stackPointer == 0)
+                throw std::out_of_range("Return from subroutine with an empty stack");
             programCounter = stack[--stackPointer];
             programCounter += 2;
             break;
         default :
-            std::cerr << "Unsupported 0xNNN opcode recieved : " << opcode << "\n";
+            logOpcode("Unsupported 0xNNN opcode recieved : ", opcode);
             break;
         }
         break;
@@ -115,7 +118,7 @@ void Chip8::emulateCycle() {
             programCounter += VX == VY ? 4 : 2;
         }
         else {
-            std::cerr << "Invalid opcode expected 0x5XY0 instead recieved : " << opcode << "\n";
+            logOpcode("Invalid opcode expected 0x5XY0 instead recieved : ", opcode);
         }
         break;
     case 0x6000: // 6XNN : set VX to NN
@@ -178,7 +181,7 @@ void Chip8::emulateCycle() {
             programCounter += 2;
             break;
         default:
-            std::cerr << "Unkown opcode, expected 0x8XY(1-7,E) recieved : " << opcode << "\n";
+            logOpcode("Unkown opcode, expected 0x8XY(1-7,E) recieved : ", opcode);
         }
 
         break;
@@ -189,7 +192,7 @@ void Chip8::emulateCycle() {
             programCounter += VX != VY ? 4 : 2;
         }
         else {
-            std::cerr << "Unkown opcode, expected 0x9XY0 recieved : " << opcode << "\n";
+            logOpcode("Unkown opcode, expected 0x9XY0 recieved : ", opcode);
         }
         break;
     case 0xA000: // ANN : set I to NNN
@@ -250,7 +253,7 @@ void Chip8::emulateCycle() {
             break;
         }
         default :
-            std::cerr << "Unkown opcode, expected 0xEX(9E, A1) recieved : " << opcode << "\n";
+            logOpcode("Unkown opcode, expected 0xEX(9E, A1) recieved : ", opcode);
         }
 
         break;
@@ -318,17 +321,15 @@ void Chip8::emulateCycle() {
             break;
         }
         default :
-            std::cerr << "Unkown opcode, expected 0xFN(07,0A,15,18,1E,29,33,55,65) recieved : " << opcode << "\n";
+            logOpcode("Unkown opcode, expected 0xFN(07,0A,15,18,1E,29,33,55,65) recieved : ", opcode);
         }
 
         break;
     default:
-        std::cerr << "Unkown opcode\n";
+        logOpcode("Unkown opcode : ", opcode);
 
     }
     updateTimers();
-
-    std::cerr << std::dec << std::flush;
 }
 
 void Chip8::updateTimers() noexcept {
@@ -344,10 +345,45 @@ void Chip8::updateTimers() noexcept {
 }
 
 uint8_t Chip8::getRand8Bit() {
-    static std::random_device device;
-    static std::default_random_engine engine(device());
-    static std::uniform_int_distribution<short> distance(0,255); // <-- undefined behavior if short is uint8_t
-    return static_cast<uint8_t>(distance(engine));
+    // the top byte of the output, distributions are implemented differently by each standard library
+    return static_cast<uint8_t>(randomEngine() >> 24);
+}
+
+void Chip8::seedRandom(uint32_t seed) {
+    randomEngine.seed(seed);
+}
+
+void Chip8::setLogging(bool enabled) noexcept {
+    logging = enabled;
+}
+
+void Chip8::logOpcode(const char* message, uint16_t opcode) const {
+    if (logging)
+        std::cerr << message << std::hex << opcode << std::dec << std::endl;
+}
+
+void Chip8::setKey(uint8_t key, bool pressed) {
+    keys.at(key) = pressed ? 1 : 0;
+}
+
+uint16_t Chip8::getProgramCounter() const noexcept {
+    return programCounter;
+}
+
+uint8_t Chip8::getStackPointer() const noexcept {
+    return stackPointer;
+}
+
+uint16_t Chip8::getIndexRegister() const noexcept {
+    return indexRegister;
+}
+
+const std::array<uint8_t, 16>& Chip8::getRegisters() const noexcept {
+    return registers;
+}
+
+uint16_t Chip8::getOpcode() const noexcept {
+    return currentOpcode;
 }
 
 // Determines if it needs to draw the screen
@@ -355,6 +391,19 @@ bool Chip8::isDrawFlag() const noexcept {
     return drawFlag;
 }
 
+static_assert(WIDTH == 64, "A packed row of pixels must fit in 64 bits");
+
+std::array<uint64_t, HEIGHT> Chip8::getPackedPixels() const noexcept {
+    std::array<uint64_t, HEIGHT> packed{};
+    for (std::size_t y = 0; y != HEIGHT; y++) {
+        uint64_t row = 0;
+        for (uint8_t pixel : pixels[y])
+            row = (row << 1) | (pixel & 1);
+        packed[y] = row;
+    }
+    return packed;
+}
+
 bool Chip8::isSoundFlag() const noexcept {
     return soundFlag;
 }
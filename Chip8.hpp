@@ -8,6 +8,7 @@
 #include <string>
 #include <random>
 #include <fstream>
+#include <vector>
 #include <stdint.h>
 
 // Memory Map : 0x000 (0) - Start of Chip-8 ram
@@ -29,10 +30,37 @@ public:
 
     void loadGame(const std::string&);
 
+    // load a ROM image already in memory, throws if it does not fit from 0x200 to 0xFFF
+    void loadGame(const std::vector<uint8_t>&);
+
+    // execute one instruction, throws std::out_of_range if the program counter or the stack leave their range
     void emulateCycle();
 
+    // Reseed the random number generator used by CXNN so runs can be reproduced
+    void seedRandom(uint32_t seed);
+
+    // Enable or disable the diagnostics printed for unknown opcodes
+    void setLogging(bool enabled) noexcept;
+
+    // Press or release one of the 16 keys (0x0 - 0xF)
+    void setKey(uint8_t key, bool pressed);
+
+    uint16_t getProgramCounter() const noexcept;
+
+    uint8_t getStackPointer() const noexcept;
+
+    uint16_t getIndexRegister() const noexcept;
+
+    const std::array<uint8_t, 16>& getRegisters() const noexcept;
+
+    // The opcode executed by the last call to emulateCycle
+    uint16_t getOpcode() const noexcept;
+
     bool isDrawFlag() const noexcept;
 
+    // The screen with one bit per pixel, a row fits in 64 bits and the leftmost pixel is the most significant bit
+    std::array<uint64_t, HEIGHT> getPackedPixels() const noexcept;
+
     void removeDrawFlag() noexcept;
 
     bool isSoundFlag() const noexcept;
@@ -74,6 +102,13 @@ private:
     // determines if the program need to make a sound.S
     bool soundFlag = false;
 
+    // determines if unknown opcodes are reported on std::cerr
+    bool logging = true;
+
+    // each emulator owns its generator so several can run on different threads,
+    // mt19937 produces the same sequence with every standard library so seeded runs can be compared
+    std::mt19937 randomEngine{std::random_device{}()};
+
     // CHIP-8 Provides a fontset for programs to display 0-F characters called sprites
     // The program needs to know where the binary representation of the sprite is located
     // where the fontset will be loaded into memory( from 0x0000).
@@ -99,6 +134,8 @@ private:
     void updateTimers() noexcept;
 
     uint8_t getRand8Bit();
+
+    void logOpcode(const char* message, uint16_t opcode) const;
 };
 
 
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Compositor.hpp"
+
+// std::min takes it by reference, C++14 needs a definition
+constexpr std::size_t Compositor::maxPersistence;
+
+Compositor::Compositor(unsigned scale, std::size_t persistence, float decay)
+    : scale(std::max(1u, scale)), persistence(std::min(std::max<std::size_t>(persistence, 1), maxPersistence)),
+      decay(decay) {
+    updateColours();
+}
+
+void Compositor::setPalette(uint32_t off, uint32_t on) {
+    this->off = off;
+    this->on = on;
+    updateColours();
+}
+
+void Compositor::setPersistence(std::size_t screens, float decay) {
+    this->persistence = std::min(std::max<std::size_t>(screens, 1), maxPersistence);
+    this->decay = decay;
+    updateColours();
+}
+
+void Compositor::setScale(unsigned scale) {
+    this->scale = std::max(1u, scale);
+}
+
+void Compositor::push(const Frame& frame) noexcept {
+    head = (head + 1) % maxPersistence;
+    history[head] = frame;
+    count = std::min(count + 1, maxPersistence);
+}
+
+void Compositor::clear() noexcept {
+    count = 0;
+}
+
+const std::vector<uint32_t>& Compositor::compose() {
+    image.resize(static_cast<std::size_t>(width()) * height());
+    const std::size_t screens = std::min(count, persistence);
+    const std::size_t rowLength = width();
+
+    for (std::size_t y = 0; y != HEIGHT; y++) {
+        // bit planes of the age of every pixel in the row, the newest screen a pixel is lit in wins
+        uint64_t unseen = ~0ull;
+        uint64_t plane0 = 0, plane1 = 0, plane2 = 0;
+        for (std::size_t age = 0; age != screens; age++) {
+            uint64_t lit = history[(head + maxPersistence - age) % maxPersistence][y] & unseen;
+            unseen &= ~lit;
+            std::size_t index = age + 1;
+            plane0 |= (index & 1) ? lit : 0;
+            plane1 |= (index & 2) ? lit : 0;
+            plane2 |= (index & 4) ? lit : 0;
+        }
+
+        // expand the first line of the row, then copy it for the rest of the enlarged row
+        uint32_t* line = image.data() + y * scale * rowLength;
+        uint32_t* out = line;
+        for (int bit = WIDTH - 1; bit >= 0; bit--) {
+            std::size_t index = ((plane0 >> bit) & 1) | (((plane1 >> bit) & 1) << 1) | (((plane2 >> bit) & 1) << 2);
+            out = std::fill_n(out, scale, colours[index]);
+        }
+        for (unsigned repeat = 1; repeat < scale; repeat++)
+            std::copy(line, line + rowLength, line + repeat * rowLength);
+    }
+    return image;
+}
+
+unsigned Compositor::width() const noexcept {
+    return WIDTH * scale;
+}
+
+unsigned Compositor::height() const noexcept {
+    return HEIGHT * scale;
+}
+
+void Compositor::updateColours() {
+    colours.fill(off);
+    float weight = 1.0f;
+    for (std::size_t age = 0; age != persistence; age++) {
+        uint32_t colour = 0;
+        // blend every 8 bit channel from off to on
+        for (int shift = 0; shift != 32; shift += 8) {
+            float from = static_cast<float>((off >> shift) & 0xFF);
+            float to = static_cast<float>((on >> shift) & 0xFF);
+            uint32_t channel = static_cast<uint32_t>(std::lround(from + (to - from) * weight));
+            colour |= std::min(channel, 0xFFu) << shift;
+        }
+        colours[age + 1] = colour;
+        weight *= decay;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef COMPOSITOR_HPP
+#define COMPOSITOR_HPP
+
+#include <array>
+#include <vector>
+#include <stdint.h>
+
+#include "Chip8.hpp"
+
+// Turns the last few screens of the emulator into an image with phosphor persistence.
+// A pixel lit in the newest screen has the on colour, a pixel last lit k screens ago fades
+// towards the off colour by decay^k, so sprites erased and redrawn between two paints no longer flicker.
+// Screens are kept packed (one 64 bit word per row) and every row is composed with bitwise operations
+// before being expanded to scale x scale blocks of 32 bit pixels (0xAARRGGBB).
+class Compositor {
+public:
+    using Frame = std::array<uint64_t, HEIGHT>;
+
+    // a pixel's age is stored in 3 bit planes, 0 is reserved for pixels that are off in every screen
+    static constexpr std::size_t maxPersistence = 7;
+
+    explicit Compositor(unsigned scale = 10, std::size_t persistence = 3, float decay = 0.5f);
+
+    // Colours used for pixels that are off and on, 0xAARRGGBB
+    void setPalette(uint32_t off, uint32_t on);
+
+    // Number of screens blended together (1 disables persistence) and the fading per screen
+    void setPersistence(std::size_t screens, float decay);
+
+    void setScale(unsigned scale);
+
+    // Add the newest screen
+    void push(const Frame& frame) noexcept;
+
+    // Forget every screen
+    void clear() noexcept;
+
+    // Compose the screens into the image, width() * height() pixels row by row
+    const std::vector<uint32_t>& compose();
+
+    unsigned width() const noexcept;
+    unsigned height() const noexcept;
+private:
+    void updateColours();
+
+    unsigned scale;
+    std::size_t persistence;
+    float decay;
+    uint32_t off = 0xFF000000;
+    uint32_t on = 0xFFFFFFFF;
+    // colours indexed by 1 + the age of a pixel, 0 is off
+    std::array<uint32_t, maxPersistence + 1> colours{};
+
+    // ring buffer of the newest screens, head is the newest
+    std::array<Frame, maxPersistence> history{};
+    std::size_t head = 0;
+    std::size_t count = 0;
+
+    std::vector<uint32_t> image;
+};
+
+#endif // COMPOSITOR_HPP
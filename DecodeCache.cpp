@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#include "DecodeCache.hpp"
+#include "Hash.hpp"
+
+namespace {
+
+// Copy the records out of a cache file, returns false if it does not belong to the ROM or is truncated
+template <typename Header>
+bool parse(const char* data, std::size_t size, uint64_t hash, uint32_t romSize, RomAnalysis& analysis) {
+    Header header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "C8DC", 4) != 0 || header.version != RomAnalysis::engineVersion ||
+            header.romHash != hash || header.romSize != romSize)
+        return false;
+
+    std::size_t instructionBytes = header.instructions * sizeof(DecodedInstruction);
+    std::size_t blockBytes = header.blocks * sizeof(uint16_t);
+    if (size != sizeof(header) + instructionBytes + blockBytes)
+        return false;
+
+    const char* records = data + sizeof(header);
+    analysis.instructions.resize(header.instructions);
+    std::memcpy(analysis.instructions.data(), records, instructionBytes);
+    analysis.blockStarts.resize(header.blocks);
+    std::memcpy(analysis.blockStarts.data(), records + instructionBytes, blockBytes);
+    analysis.quirkOpcodes = header.quirkOpcodes;
+    return true;
+}
+
+}
+
+DecodeCache::DecodeCache(const std::string& directory) : directory(directory) {
+}
+
+RomAnalysis DecodeCache::load(const std::vector<uint8_t>& rom, Stats& stats) const {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hash = Hash::fnv1a(rom);
+    std::string path = pathOf(hash);
+    uint32_t romSize = static_cast<uint32_t>(rom.size());
+
+    RomAnalysis analysis;
+    stats.hit = read(path, hash, romSize, analysis);
+    if (!stats.hit) {
+        analysis = RomAnalysis::analyze(rom);
+        write(path, hash, romSize, analysis, stats.writeError);
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return analysis;
+}
+
+std::string DecodeCache::pathOf(uint64_t hash) const {
+    std::ostringstream path;
+    path << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << hash
+         << std::dec << "-v" << RomAnalysis::engineVersion << ".c8dc";
+    return path.str();
+}
+
+bool DecodeCache::read(const std::string& path, uint64_t hash, uint32_t romSize, RomAnalysis& analysis) const {
+    std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+    if (!ifs.good())
+        return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return parse<Header>(data.data(), data.size(), hash, romSize, analysis);
+}
+
+bool DecodeCache::write(const std::string& path, uint64_t hash, uint32_t romSize, const RomAnalysis& analysis, std::string& error) const {
+    Header header;
+    std::memcpy(header.magic, "C8DC", 4);
+    header.version = RomAnalysis::engineVersion;
+    header.romHash = hash;
+    header.romSize = romSize;
+    header.instructions = static_cast<uint32_t>(analysis.instructions.size());
+    header.blocks = static_cast<uint32_t>(analysis.blockStarts.size());
+    header.quirkOpcodes = analysis.quirkOpcodes;
+
+    // write next to the entry and rename it, a reader never sees a partial file
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream ofs(temporary, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(analysis.instructions.data()),
+                  static_cast<std::streamsize>(analysis.instructions.size() * sizeof(DecodedInstruction)));
+        ofs.write(reinterpret_cast<const char*>(analysis.blockStarts.data()),
+                  static_cast<std::streamsize>(analysis.blockStarts.size() * sizeof(uint16_t)));
+        if (!ofs.good()) {
+            ofs.close();
+            std::remove(temporary.c_str());
+            error = "Unable to write " + temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        error = "Unable to rename " + temporary + " to " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef DECODECACHE_HPP
+#define DECODECACHE_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "RomAnalysis.hpp"
+
+// Keeps the RomAnalysis of every ROM on disk so it is only computed the first time a ROM is played.
+// Entries are named after the hash of the ROM and RomAnalysis::engineVersion, a file holds :
+//   Header, Header::instructions DecodedInstruction records, Header::blocks block start addresses (uint16)
+// in the byte order of the machine, so the records are copied back without decoding them again.
+class DecodeCache {
+public:
+    struct Stats {
+        bool hit = false;
+        // why the analysis could not be stored after a miss, empty if it was
+        std::string writeError;
+        // time spent reading the cache, or analysing and writing on a miss
+        double seconds = 0;
+    };
+
+    explicit DecodeCache(const std::string& directory);
+
+    // The analysis of the ROM, read from the cache or computed and stored
+    RomAnalysis load(const std::vector<uint8_t>& rom, Stats& stats) const;
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t romHash;
+        uint32_t romSize;
+        uint32_t instructions;
+        uint32_t blocks;
+        uint32_t quirkOpcodes;
+    };
+
+    std::string pathOf(uint64_t hash) const;
+    bool read(const std::string& path, uint64_t hash, uint32_t romSize, RomAnalysis& analysis) const;
+    // returns false and sets error if the entry could not be stored
+    bool write(const std::string& path, uint64_t hash, uint32_t romSize, const RomAnalysis& analysis, std::string& error) const;
+
+    std::string directory;
+};
+
+#endif // DECODECACHE_HPP
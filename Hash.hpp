@@ -0,0 +1,28 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+// 64 bit FNV-1a, used to name ROMs and compare screens.
+// Not a cryptographic hash, pass a previous result as hash to continue it over more data.
+namespace Hash {
+
+const uint64_t fnvOffset = 0xcbf29ce484222325ull;
+
+inline uint64_t fnv1a(const uint8_t* data, std::size_t size, uint64_t hash = fnvOffset) noexcept {
+    for (std::size_t i = 0; i != size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a(const std::vector<uint8_t>& bytes, uint64_t hash = fnvOffset) noexcept {
+    return fnv1a(bytes.data(), bytes.size(), hash);
+}
+
+}
+
+#endif // HASH_HPP
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <array>
+
+#include "RomAnalysis.hpp"
+
+namespace {
+
+bool isSkip(InstructionKind kind) noexcept {
+    switch (kind) {
+    case InstructionKind::SkipEqualImmediate:
+    case InstructionKind::SkipNotEqualImmediate:
+    case InstructionKind::SkipEqualRegister:
+    case InstructionKind::SkipNotEqualRegister:
+    case InstructionKind::SkipKeyPressed:
+    case InstructionKind::SkipKeyNotPressed:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+InstructionKind RomAnalysis::decode(uint16_t opcode) noexcept {
+    switch (opcode & 0xF000) {
+    case 0x0000:
+        if (opcode == 0x00E0) return InstructionKind::ClearScreen;
+        if (opcode == 0x00EE) return InstructionKind::Return;
+        return InstructionKind::System;
+    case 0x1000: return InstructionKind::Jump;
+    case 0x2000: return InstructionKind::Call;
+    case 0x3000: return InstructionKind::SkipEqualImmediate;
+    case 0x4000: return InstructionKind::SkipNotEqualImmediate;
+    case 0x5000: return (opcode & 0x000F) == 0 ? InstructionKind::SkipEqualRegister : InstructionKind::Unknown;
+    case 0x6000: return InstructionKind::LoadImmediate;
+    case 0x7000: return InstructionKind::AddImmediate;
+    case 0x8000:
+        switch (opcode & 0x000F) {
+        case 0x0: return InstructionKind::Move;
+        case 0x1: return InstructionKind::Or;
+        case 0x2: return InstructionKind::And;
+        case 0x3: return InstructionKind::Xor;
+        case 0x4: return InstructionKind::Add;
+        case 0x5: return InstructionKind::Subtract;
+        case 0x6: return InstructionKind::ShiftRight;
+        case 0x7: return InstructionKind::SubtractReverse;
+        case 0xE: return InstructionKind::ShiftLeft;
+        default: return InstructionKind::Unknown;
+        }
+    case 0x9000: return (opcode & 0x000F) == 0 ? InstructionKind::SkipNotEqualRegister : InstructionKind::Unknown;
+    case 0xA000: return InstructionKind::LoadIndex;
+    case 0xB000: return InstructionKind::JumpOffset;
+    case 0xC000: return InstructionKind::Random;
+    case 0xD000: return InstructionKind::Draw;
+    case 0xE000:
+        if ((opcode & 0x00FF) == 0x9E) return InstructionKind::SkipKeyPressed;
+        if ((opcode & 0x00FF) == 0xA1) return InstructionKind::SkipKeyNotPressed;
+        return InstructionKind::Unknown;
+    default:
+        switch (opcode & 0x00FF) {
+        case 0x07: return InstructionKind::LoadDelay;
+        case 0x0A: return InstructionKind::WaitKey;
+        case 0x15: return InstructionKind::SetDelay;
+        case 0x18: return InstructionKind::SetSound;
+        case 0x1E: return InstructionKind::AddIndex;
+        case 0x29: return InstructionKind::LoadFont;
+        case 0x33: return InstructionKind::StoreBcd;
+        case 0x55: return InstructionKind::StoreRegisters;
+        case 0x65: return InstructionKind::LoadRegisters;
+        default: return InstructionKind::Unknown;
+        }
+    }
+}
+
+// Follow every path from 0x200 through the ROM, so data mixed with code is not decoded
+// and code at odd addresses is found.
+// Targets outside of the ROM and computed jumps (BNNN) can not be followed.
+RomAnalysis RomAnalysis::analyze(const std::vector<uint8_t>& rom) {
+    const std::size_t start = 0x200;
+    const std::size_t end = start + rom.size();
+    auto inRom = [&](std::size_t address) { return address >= start && address + 1 < end; };
+
+    std::array<bool, 0x1000> visited{};
+    std::array<bool, 0x1000> leader{};
+    std::vector<std::size_t> pending;
+    auto follow = [&](std::size_t address, bool startsBlock) {
+        if (!inRom(address))
+            return;
+        if (startsBlock)
+            leader[address] = true;
+        if (!visited[address]) {
+            visited[address] = true;
+            pending.push_back(address);
+        }
+    };
+
+    RomAnalysis analysis;
+    follow(start, true);
+    while (!pending.empty()) {
+        std::size_t address = pending.back();
+        pending.pop_back();
+
+        uint16_t opcode = static_cast<uint16_t>(rom[address - start] << 8 | rom[address - start + 1]);
+        DecodedInstruction instruction{static_cast<uint16_t>(address), opcode, decode(opcode), 0, 0};
+        switch (instruction.kind) {
+        case InstructionKind::Jump:
+            instruction.target = opcode & 0x0FFF;
+            instruction.flags |= DecodedInstruction::BlockEnd;
+            follow(instruction.target, true);
+            break;
+        case InstructionKind::Call:
+            instruction.target = opcode & 0x0FFF;
+            instruction.flags |= DecodedInstruction::BlockEnd;
+            follow(instruction.target, true);
+            follow(address + 2, true);
+            break;
+        // Chip8 does not move past 0NNN, it is the end of that path
+        case InstructionKind::Return:
+        case InstructionKind::JumpOffset:
+        case InstructionKind::System:
+        case InstructionKind::Unknown:
+            instruction.flags |= DecodedInstruction::BlockEnd;
+            break;
+        default:
+            if (isSkip(instruction.kind)) {
+                instruction.flags |= DecodedInstruction::BlockEnd;
+                follow(address + 2, true);
+                follow(address + 4, true);
+            }
+            else
+                follow(address + 2, false);
+        }
+
+        uint8_t x = (opcode & 0x0F00) >> 8;
+        uint8_t y = (opcode & 0x00F0) >> 4;
+        switch (instruction.kind) {
+        case InstructionKind::ShiftRight:
+        case InstructionKind::ShiftLeft:
+            if (x != y)
+                analysis.quirkOpcodes |= UsesShiftWithVY;
+            break;
+        case InstructionKind::StoreRegisters:
+        case InstructionKind::LoadRegisters:
+            analysis.quirkOpcodes |= UsesLoadStoreRegisters;
+            break;
+        case InstructionKind::JumpOffset:
+            analysis.quirkOpcodes |= UsesJumpOffset;
+            break;
+        case InstructionKind::Or:
+        case InstructionKind::And:
+        case InstructionKind::Xor:
+            analysis.quirkOpcodes |= UsesLogic;
+            break;
+        case InstructionKind::AddIndex:
+            analysis.quirkOpcodes |= UsesAddIndex;
+            break;
+        default:
+            break;
+        }
+        analysis.instructions.push_back(instruction);
+    }
+
+    std::sort(analysis.instructions.begin(), analysis.instructions.end(),
+              [](const DecodedInstruction& a, const DecodedInstruction& b) { return a.address < b.address; });
+    for (DecodedInstruction& instruction : analysis.instructions) {
+        if (leader[instruction.address]) {
+            instruction.flags |= DecodedInstruction::BlockStart;
+            analysis.blockStarts.push_back(instruction.address);
+        }
+    }
+    return analysis;
+}
+
+std::string RomAnalysis::describeQuirkOpcodes() const {
+    static const std::array<std::pair<QuirkOpcode, const char*>, 5> names = {{
+        {UsesShiftWithVY, "8XY6/8XYE with X != Y"},
+        {UsesLoadStoreRegisters, "FX55/FX65"},
+        {UsesJumpOffset, "BNNN"},
+        {UsesLogic, "8XY1/8XY2/8XY3"},
+        {UsesAddIndex, "FX1E"}
+    }};
+
+    std::string description;
+    for (const auto& name : names) {
+        if (quirkOpcodes & name.first)
+            description += (description.empty() ? "" : ", ") + std::string(name.second);
+    }
+    return description.empty() ? "none" : description;
+}
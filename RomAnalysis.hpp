@@ -0,0 +1,66 @@
+#ifndef ROMANALYSIS_HPP
+#define ROMANALYSIS_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Instructions of the CHIP-8 instruction set, named after what Chip8::emulateCycle does with them
+enum class InstructionKind : uint8_t {
+    Unknown, System, ClearScreen, Return, Jump, Call, SkipEqualImmediate, SkipNotEqualImmediate,
+    SkipEqualRegister, LoadImmediate, AddImmediate, Move, Or, And, Xor, Add, Subtract, ShiftRight,
+    SubtractReverse, ShiftLeft, SkipNotEqualRegister, LoadIndex, JumpOffset, Random, Draw,
+    SkipKeyPressed, SkipKeyNotPressed, LoadDelay, WaitKey, SetDelay, SetSound, AddIndex, LoadFont,
+    StoreBcd, StoreRegisters, LoadRegisters
+};
+
+// One decoded instruction, a plain 8 byte record so a list of them can be written and read back as is
+struct DecodedInstruction {
+    enum Flags : uint8_t {
+        BlockStart = 1, // first instruction of a basic block
+        BlockEnd = 2    // transfers control, the basic block ends here
+    };
+
+    uint16_t address;
+    uint16_t opcode;
+    InstructionKind kind;
+    uint8_t flags;
+    // NNN of jumps and calls, 0 otherwise
+    uint16_t target;
+};
+
+static_assert(sizeof(DecodedInstruction) == 8, "DecodedInstruction is stored on disk as 8 bytes");
+
+// Static analysis of a ROM : the instructions reachable from 0x200, where its basic blocks start,
+// and which of the opcodes that behave differently between CHIP-8 interpreters (quirks) it contains.
+// A ROM using one of them does not necessarily depend on the quirk, e.g. FX55 only does if I is read afterwards.
+struct RomAnalysis {
+    // Bump whenever decoding or the analysis changes so cached results are recomputed
+    static constexpr uint32_t engineVersion = 1;
+
+    enum QuirkOpcode : uint32_t {
+        // 8XY6 / 8XYE with X != Y, the original interpreter shifted VY into VX
+        UsesShiftWithVY = 1,
+        // FX55 / FX65, interpreters disagree on whether I is incremented
+        UsesLoadStoreRegisters = 2,
+        // BNNN, CHIP-48 jumps to XNN + VX instead of NNN + V0
+        UsesJumpOffset = 4,
+        // 8XY1 / 8XY2 / 8XY3, the original interpreter reset VF
+        UsesLogic = 8,
+        // FX1E, some interpreters set VF when I overflows
+        UsesAddIndex = 16
+    };
+
+    std::vector<DecodedInstruction> instructions;
+    std::vector<uint16_t> blockStarts;
+    uint32_t quirkOpcodes = 0;
+
+    static RomAnalysis analyze(const std::vector<uint8_t>& rom);
+
+    static InstructionKind decode(uint16_t opcode) noexcept;
+
+    // Opcodes set in quirkOpcodes, separated by commas
+    std::string describeQuirkOpcodes() const;
+};
+
+#endif // ROMANALYSIS_HPP
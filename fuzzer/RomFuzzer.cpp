@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "Hash.hpp"
+#include "RomFuzzer.hpp"
+
+namespace {
+
+// Opcodes that stress the edges of the interpreter: subroutine calls and returns,
+// jumps and I close to the end of memory and memory writes through I.
+const std::array<uint16_t, 12> interestingOpcodes = {
+    0x00EE, 0x2200, 0x1FFE, 0xBFFF, 0xAFFF, 0xAFFD,
+    0xDFFF, 0xF033, 0xFF55, 0xFF65, 0xFF1E, 0xF00A
+};
+
+// AFL style bucketing of hit counts, so loops that run a different number of times count as new coverage
+uint8_t bucket(uint8_t hits) noexcept {
+    if (hits == 0) return 0;
+    if (hits == 1) return 1;
+    if (hits == 2) return 2;
+    if (hits == 3) return 4;
+    if (hits < 8) return 8;
+    if (hits < 16) return 16;
+    if (hits < 32) return 32;
+    if (hits < 128) return 64;
+    return 128;
+}
+
+// splitmix64, the key schedule only depends on the seed of the run and the cycle
+uint64_t mix(uint64_t value) noexcept {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+}
+
+// std::min takes it by reference, C++14 needs a definition
+constexpr std::size_t RomFuzzer::maxRomSize;
+
+RomFuzzer::RomFuzzer(const Options& options) : options(options) {
+    if (this->options.threads == 0)
+        this->options.threads = 1;
+}
+
+void RomFuzzer::addSeed(const std::vector<uint8_t>& rom) {
+    std::vector<uint8_t> seed(rom.cbegin(), rom.cbegin() + static_cast<long>(std::min(rom.size(), maxRomSize)));
+    std::lock_guard<std::mutex> lock(corpusMutex);
+    corpus.push_back(std::move(seed));
+}
+
+std::size_t RomFuzzer::run() {
+    if (corpus.empty()) {
+        std::mt19937 rng(options.seed);
+        std::vector<uint8_t> seed(64);
+        std::generate(seed.begin(), seed.end(), [&rng]() { return static_cast<uint8_t>(rng()); });
+        corpus.push_back(seed);
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i != options.threads; i++)
+        workers.emplace_back(&RomFuzzer::work, this, i);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(options.seconds);
+    auto nextReport = start + std::chrono::seconds(1);
+    while (!stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || (options.maxExecs != 0 && execs >= options.maxExecs))
+            stop = true;
+        if (now >= nextReport) {
+            printStats(now - start);
+            nextReport += std::chrono::seconds(1);
+        }
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+    printStats(std::chrono::steady_clock::now() - start);
+    return crashes + hangs;
+}
+
+void RomFuzzer::work(unsigned id) {
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->rng.seed(options.seed + id);
+    worker->emulator.setLogging(false);
+
+    std::vector<uint8_t> rom;
+    while (!stop) {
+        {
+            std::lock_guard<std::mutex> lock(corpusMutex);
+            rom = corpus[worker->rng() % corpus.size()];
+        }
+        mutate(*worker, rom);
+
+        Result result = execute(*worker, rom);
+        if (++execs == options.maxExecs)
+            stop = true;
+
+        if (result.outcome != Outcome::Ok)
+            report(*worker, rom, result);
+        else if (mergeCoverage(*worker)) {
+            std::lock_guard<std::mutex> lock(corpusMutex);
+            corpus.push_back(rom);
+        }
+    }
+}
+
+RomFuzzer::Result RomFuzzer::execute(Worker& worker, const std::vector<uint8_t>& rom) const {
+    Chip8& emulator = worker.emulator;
+    std::fill(worker.trace.begin(), worker.trace.end(), 0);
+
+    // the random generator and the key presses only depend on the seed of the run, so a smaller
+    // input sees the same environment while it is minimized and a reproducer replays with -s and -R
+    emulator.initalize();
+    emulator.seedRandom(options.seed);
+    emulator.loadGame(rom);
+
+    auto start = std::chrono::steady_clock::now();
+    uint16_t previous = 0;
+    uint64_t stalled = 0;
+    for (uint64_t cycle = 0; cycle != options.cyclesPerExec; cycle++) {
+        uint16_t pc = emulator.getProgramCounter();
+
+        // press or release a key every 256 cycles
+        if ((cycle & 0xFF) == 0) {
+            uint64_t event = mix(options.seed ^ mix(cycle >> 8));
+            emulator.setKey(static_cast<uint8_t>(event & 0xF), (event & 0x10) != 0);
+        }
+
+        try {
+            emulator.emulateCycle();
+        } catch (const std::out_of_range& e) {
+            // the opcode is still the one that moved the program counter out of memory
+            return failure(Outcome::Crash, e.what(), pc > 0xFFE ? "pc" : "out_of_range", pc, emulator.getOpcode());
+        } catch (const std::exception& e) {
+            return failure(Outcome::Crash, e.what(), "exception", pc, emulator.getOpcode());
+        }
+
+        // Unknown opcodes leave the program counter where it is and the interpreter spins forever.
+        // A jump to itself is how programs halt and FX0A is released by a key, neither is a hang.
+        uint16_t opcode = emulator.getOpcode();
+        stalled = emulator.getProgramCounter() == pc ? stalled + 1 : 0;
+        if (stalled == options.stallCycles && (opcode & 0xF000) != 0x1000 && (opcode & 0xF000) != 0xB000 &&
+                (opcode & 0xF0FF) != 0xF00A)
+            // every unknown opcode of a family stalls the same way, report them once
+            return failure(Outcome::Hang, "program counter stalled", "stall", pc, opcode & 0xF000);
+
+        uint16_t location = static_cast<uint16_t>((pc * 0x9E37u) ^ (opcode >> 12));
+        uint8_t& hits = worker.trace[(location ^ previous) % mapSize];
+        if (hits != 0xFF)
+            ++hits;
+        previous = static_cast<uint16_t>(location >> 1);
+
+        // a last resort for runs with a very large cycle budget
+        if ((cycle & 0x3FF) == 0x3FF &&
+                std::chrono::steady_clock::now() - start > std::chrono::milliseconds(options.timeoutMs))
+            return failure(Outcome::Hang, "execution timed out", "timeout", pc, emulator.getOpcode());
+    }
+    return Result();
+}
+
+RomFuzzer::Result RomFuzzer::failure(Outcome outcome, const std::string& reason, const char* kind, uint16_t pc, uint16_t opcode) {
+    // keep the parts of the opcode that select the instruction, drop the registers and addresses
+    uint16_t mask = 0xF000;
+    switch (opcode & 0xF000) {
+    case 0x0000: case 0xE000: case 0xF000: mask = 0xF0FF; break;
+    case 0x5000: case 0x8000: case 0x9000: mask = 0xF00F; break;
+    }
+
+    Result result;
+    result.outcome = outcome;
+    result.reason = reason;
+    result.programCounter = pc;
+    std::ostringstream signature;
+    signature << kind << '-' << std::hex << std::setw(4) << std::setfill('0') << (opcode & mask);
+    result.signature = signature.str();
+    return result;
+}
+
+void RomFuzzer::mutate(Worker& worker, std::vector<uint8_t>& rom) {
+    std::mt19937& rng = worker.rng;
+    unsigned stacked = 1 + rng() % 8;
+    for (unsigned i = 0; i != stacked; i++) {
+        // keep instructions aligned, CHIP-8 programs are made of 2 byte opcodes
+        std::size_t word = rom.size() >= 2 ? (rng() % (rom.size() / 2)) * 2 : 0;
+        switch (rng() % 7) {
+        case 0: // flip a bit
+            if (!rom.empty())
+                rom[rng() % rom.size()] ^= static_cast<uint8_t>(1 << (rng() % 8));
+            break;
+        case 1: // random byte
+            if (!rom.empty())
+                rom[rng() % rom.size()] = static_cast<uint8_t>(rng());
+            break;
+        case 2: { // replace an opcode by an interesting one, with a random register
+            if (rom.size() < 2)
+                break;
+            uint16_t opcode = interestingOpcodes[rng() % interestingOpcodes.size()];
+            if ((opcode & 0xF000) == 0xF000 || (opcode & 0xF000) == 0xD000)
+                opcode = static_cast<uint16_t>((opcode & 0xF0FF) | ((rng() % 16) << 8));
+            // 2NNN calling itself overflows the stack
+            if (opcode == 0x2200)
+                opcode = static_cast<uint16_t>(0x2000 | (0x200 + word));
+            rom[word] = static_cast<uint8_t>(opcode >> 8);
+            rom[word + 1] = static_cast<uint8_t>(opcode);
+            break;
+        }
+        case 3: // insert a random opcode
+            if (rom.size() + 2 <= maxRomSize) {
+                uint16_t opcode = static_cast<uint16_t>(rng());
+                rom.insert(rom.begin() + static_cast<long>(word), {static_cast<uint8_t>(opcode >> 8), static_cast<uint8_t>(opcode)});
+            }
+            break;
+        case 4: // delete an opcode
+            if (rom.size() > 2)
+                rom.erase(rom.begin() + static_cast<long>(word), rom.begin() + static_cast<long>(word) + 2);
+            break;
+        case 5: { // splice with another input of the corpus
+            std::vector<uint8_t> other;
+            {
+                std::lock_guard<std::mutex> lock(corpusMutex);
+                other = corpus[rng() % corpus.size()];
+            }
+            if (other.size() < 2)
+                break;
+            std::size_t from = (rng() % (other.size() / 2)) * 2;
+            rom.resize(word);
+            rom.insert(rom.end(), other.cbegin() + static_cast<long>(from), other.cend());
+            if (rom.size() > maxRomSize)
+                rom.resize(maxRomSize);
+            break;
+        }
+        default: // copy an opcode over another one
+            if (rom.size() >= 4) {
+                std::size_t from = (rng() % (rom.size() / 2)) * 2;
+                rom[word] = rom[from];
+                rom[word + 1] = rom[from + 1];
+            }
+            break;
+        }
+    }
+    if (rom.empty())
+        rom.push_back(static_cast<uint8_t>(rng()));
+}
+
+bool RomFuzzer::mergeCoverage(Worker& worker) {
+    bool locallyNew = false;
+    for (std::size_t i = 0; i != mapSize; i++) {
+        uint8_t seen = bucket(worker.trace[i]);
+        worker.trace[i] = seen;
+        if (seen & ~worker.virgin[i])
+            locallyNew = true;
+    }
+    if (!locallyNew)
+        return false;
+
+    bool globallyNew = false;
+    std::lock_guard<std::mutex> lock(corpusMutex);
+    for (std::size_t i = 0; i != mapSize; i++) {
+        uint8_t seen = worker.trace[i];
+        if (seen & ~globalCoverage[i]) {
+            if (globalCoverage[i] == 0)
+                ++edges;
+            globalCoverage[i] |= seen;
+            globallyNew = true;
+        }
+        worker.virgin[i] = globalCoverage[i];
+    }
+    return globallyNew;
+}
+
+// Remove chunks of opcodes and then zero out single bytes as long as the input
+// still fails in the same way. Chunks stay a whole number of opcodes so the rest stays aligned.
+std::vector<uint8_t> RomFuzzer::minimize(Worker& worker, std::vector<uint8_t> rom, const Result& expected) const {
+    auto reproduces = [&](const std::vector<uint8_t>& candidate) {
+        if (candidate.empty())
+            return false;
+        Result result = execute(worker, candidate);
+        return result.signature == expected.signature;
+    };
+
+    std::size_t attempts = 0;
+    const std::size_t maxAttempts = 4096;
+    for (std::size_t chunk = (rom.size() / 4) * 2; chunk >= 2 && attempts < maxAttempts; chunk = chunk / 4 * 2) {
+        for (std::size_t i = 0; i < rom.size() && attempts < maxAttempts; attempts++) {
+            std::vector<uint8_t> candidate(rom);
+            candidate.erase(candidate.begin() + static_cast<long>(i),
+                            candidate.begin() + static_cast<long>(std::min(i + chunk, candidate.size())));
+            if (reproduces(candidate))
+                rom = std::move(candidate);
+            else
+                i += chunk;
+        }
+    }
+    for (std::size_t i = 0; i != rom.size() && attempts < maxAttempts; i++, attempts++) {
+        if (rom[i] == 0)
+            continue;
+        uint8_t old = rom[i];
+        rom[i] = 0;
+        if (!reproduces(rom))
+            rom[i] = old;
+    }
+    return rom;
+}
+
+void RomFuzzer::report(Worker& worker, const std::vector<uint8_t>& rom, const Result& result) {
+    {
+        std::lock_guard<std::mutex> lock(findingsMutex);
+        if (!signatures.insert(result.signature).second)
+            return;
+    }
+
+    // a timeout is not reproducible, only stalls and crashes can be shrunk
+    std::vector<uint8_t> reproducer(rom);
+    if (result.signature.compare(0, 7, "timeout") != 0)
+        reproducer = minimize(worker, rom, result);
+    if (result.outcome == Outcome::Crash)
+        ++crashes;
+    else
+        ++hangs;
+
+    std::ostringstream fileName;
+    fileName << options.outputDir << '/' << (result.outcome == Outcome::Crash ? "crash-" : "hang-")
+             << result.signature << '-' << std::hex << std::setw(16) << std::setfill('0') << Hash::fnv1a(reproducer) << ".ch8";
+    std::ofstream ofs(fileName.str(), std::ios_base::out | std::ios_base::binary);
+    ofs.write(reinterpret_cast<const char*>(reproducer.data()), static_cast<std::streamsize>(reproducer.size()));
+
+    std::lock_guard<std::mutex> lock(findingsMutex);
+    std::cout << (result.outcome == Outcome::Crash ? "crash" : "hang") << " at 0x" << std::hex << result.programCounter
+              << std::dec << " (" << result.signature << ") : " << result.reason << ", " << rom.size() << " -> " << reproducer.size()
+              << " bytes, saved to " << fileName.str() << ", replay with -s " << options.seed << " -c "
+              << options.cyclesPerExec << " -R " << fileName.str() << std::endl;
+}
+
+bool RomFuzzer::replay(const std::vector<uint8_t>& rom) {
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->emulator.setLogging(false);
+    Result result = execute(*worker, std::vector<uint8_t>(rom.cbegin(), rom.cbegin() + static_cast<long>(std::min(rom.size(), maxRomSize))));
+    if (result.outcome == Outcome::Ok) {
+        std::cout << "no failure in " << options.cyclesPerExec << " cycles" << std::endl;
+        return false;
+    }
+    std::cout << (result.outcome == Outcome::Crash ? "crash" : "hang") << " at 0x" << std::hex << result.programCounter
+              << std::dec << " (" << result.signature << ") : " << result.reason << std::endl;
+    return true;
+}
+
+void RomFuzzer::printStats(std::chrono::steady_clock::duration elapsed) const {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double perSecond = seconds > 0 ? static_cast<double>(execs) / seconds : 0;
+    std::size_t corpusSize;
+    std::size_t covered;
+    {
+        std::lock_guard<std::mutex> lock(corpusMutex);
+        corpusSize = corpus.size();
+        covered = edges;
+    }
+    std::lock_guard<std::mutex> lock(findingsMutex);
+    std::cout << std::fixed << std::setprecision(0)
+              << "#" << execs << " " << seconds << "s exec/s: " << perSecond
+              << " per core: " << perSecond / options.threads
+              << " corpus: " << corpusSize << " edges: " << covered
+              << " crashes: " << crashes << " hangs: " << hangs << std::endl;
+}
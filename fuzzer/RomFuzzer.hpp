@@ -0,0 +1,98 @@
+#ifndef ROMFUZZER_HPP
+#define ROMFUZZER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Chip8.hpp"
+
+// Coverage guided fuzzer for the interpreter core.
+// Every worker thread owns a Chip8 and runs mutated ROM images for a bounded number of cycles.
+// The (previous PC, PC) edges hit during a run are the feedback, inputs that reach
+// new edges are kept in a shared corpus and mutated further.
+// Inputs that throw or leave the program counter or stack outside of their range are crashes,
+// inputs that stall the program counter on an instruction no key can release are hangs.
+// Both are minimized and written into the output directory.
+class RomFuzzer {
+public:
+    struct Options {
+        unsigned threads = 1;
+        // cycles executed per input before it is considered finished
+        uint64_t cyclesPerExec = 10000;
+        // 0 runs until the time limit is reached
+        uint64_t maxExecs = 0;
+        unsigned seconds = 60;
+        // cycles the program counter may stay on an instruction that nothing can release before it is a hang
+        uint64_t stallCycles = 256;
+        // wall clock limit of a single execution before it is reported as a hang
+        unsigned timeoutMs = 1000;
+        uint32_t seed = 0;
+        std::string outputDir = ".";
+    };
+
+    explicit RomFuzzer(const Options& options);
+
+    void addSeed(const std::vector<uint8_t>& rom);
+
+    // Run all workers until the time or execution limit, returns the number of findings
+    std::size_t run();
+
+    // Execute a single input with the seed and cycles of the options, returns true if it fails
+    bool replay(const std::vector<uint8_t>& rom);
+
+private:
+    static constexpr std::size_t mapSize = 1 << 15;
+    static constexpr std::size_t maxRomSize = 0x1000 - 0x200;
+    using CoverageMap = std::array<uint8_t, mapSize>;
+
+    enum class Outcome { Ok, Crash, Hang };
+
+    struct Result {
+        Outcome outcome = Outcome::Ok;
+        std::string reason;
+        // identifies the underlying bug, the kind of failure and the opcode that caused it
+        std::string signature;
+        uint16_t programCounter = 0;
+    };
+
+    struct Worker {
+        Chip8 emulator;
+        std::mt19937 rng;
+        CoverageMap trace{};
+        // local copy of the global coverage so most executions need no lock
+        CoverageMap virgin{};
+    };
+
+    void work(unsigned id);
+    Result execute(Worker& worker, const std::vector<uint8_t>& rom) const;
+    static Result failure(Outcome outcome, const std::string& reason, const char* kind, uint16_t pc, uint16_t opcode);
+    void mutate(Worker& worker, std::vector<uint8_t>& rom);
+    bool mergeCoverage(Worker& worker);
+    std::vector<uint8_t> minimize(Worker& worker, std::vector<uint8_t> rom, const Result& expected) const;
+    void report(Worker& worker, const std::vector<uint8_t>& rom, const Result& result);
+    void printStats(std::chrono::steady_clock::duration elapsed) const;
+
+    Options options;
+
+    mutable std::mutex corpusMutex;
+    std::vector<std::vector<uint8_t>> corpus;
+    CoverageMap globalCoverage{};
+    std::size_t edges = 0;
+
+    mutable std::mutex findingsMutex;
+    std::set<std::string> signatures;
+
+    std::atomic<uint64_t> execs{0};
+    std::atomic<std::size_t> crashes{0};
+    std::atomic<std::size_t> hangs{0};
+    std::atomic<bool> stop{false};
+};
+
+#endif // ROMFUZZER_HPP
@@ -0,0 +1,22 @@
+TEMPLATE = app
+TARGET = Chip-8-fuzzer
+
+# The fuzzer only drives the interpreter core, it does not need Qt.
+QT -= core gui
+CONFIG += console c++14 thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++14
+QMAKE_CXXFLAGS_RELEASE -= -O2
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    RomFuzzer.cpp \
+    ../Chip8.cpp
+
+HEADERS += \
+    RomFuzzer.hpp \
+    ../Chip8.hpp \
+    ../Hash.hpp
@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+#include "RomFuzzer.hpp"
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage : " << program << " [options] [seed ROMs...]\n"
+              << "  -j <threads>   worker threads (default : number of cores)\n"
+              << "  -c <cycles>    cycles executed per input (default : 10000)\n"
+              << "  -t <seconds>   total running time (default : 60)\n"
+              << "  -n <execs>     stop after this many executions\n"
+              << "  -S <cycles>    cycles the program counter may stall before it is a hang (default : 256)\n"
+              << "  -T <ms>        timeout of a single execution (default : 1000)\n"
+              << "  -s <seed>      seed of the mutator, the random generator and the key presses\n"
+              << "  -R <file>      run a single input once, with the same -s and -c it was found with\n"
+              << "  -o <dir>       directory crashing and hanging inputs are written to (default : .)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    RomFuzzer::Options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> seeds;
+    std::string replay;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (arg.size() == 2 && arg[0] == '-' && hasValue) {
+            const char* value = argv[++i];
+            switch (arg[1]) {
+            case 'j': options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 'c': options.cyclesPerExec = std::strtoull(value, nullptr, 10); break;
+            case 't': options.seconds = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 'n': options.maxExecs = std::strtoull(value, nullptr, 10); break;
+            case 'S': options.stallCycles = std::strtoull(value, nullptr, 10); break;
+            case 'T': options.timeoutMs = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 's': options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10)); break;
+            case 'o': options.outputDir = value; break;
+            case 'R': replay = value; break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+            seeds.push_back(arg);
+    }
+
+    RomFuzzer fuzzer(options);
+    if (!replay.empty()) {
+        std::ifstream ifs(replay, std::ios_base::in | std::ios_base::binary);
+        if (!ifs.good()) {
+            std::cerr << "Unable to read " << replay << std::endl;
+            return 1;
+        }
+        return fuzzer.replay(std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>())) ? 2 : 0;
+    }
+
+    for (const std::string& seed : seeds) {
+        std::ifstream ifs(seed, std::ios_base::in | std::ios_base::binary);
+        if (!ifs.good()) {
+            std::cerr << "Unable to read seed " << seed << std::endl;
+            return 1;
+        }
+        fuzzer.addSeed(std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()));
+    }
+
+    return fuzzer.run() == 0 ? 0 : 2;
+}
@@ -2,6 +2,7 @@
 #include "ui_game.h"
 #include <Chip8.hpp>
 #include <iostream>
+#include <QImage>
 #include <QPainter>
 #include <thread>
 #include <QTextStream>
@@ -14,9 +15,13 @@ Game::Game(QWidget *parent) :
     QWidget(parent), ui(new Ui::Game){
     ui->setupUi(this);
     this->timer = new QTimer(this);
-    setFixedSize(QSize(WIDTH * 10, HEIGHT * 10));
+    compositor.setPalette(0xFF000000, 0xFFFFFFFF); // 0 -> black, 1 -> white
+    setFixedSize(QSize(static_cast<int>(compositor.width()), static_cast<int>(compositor.height())));
     connect(timer, &QTimer::timeout, this, &Game::runCycle);
     timer->start(1);
+    this->refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &Game::refresh);
+    refreshTimer->start(16);
     emulator.initalize();
 
     player = new QMediaPlayer();
@@ -64,10 +69,20 @@ void Game::timerEvent(QTimerEvent *) {
 }
 
 void Game::runCycle() {
-    emulator.emulateCycle();
+    try {
+        emulator.emulateCycle();
+    } catch(const std::exception& e) {
+        // the program is broken, leave its last screen up
+        std::cerr << "Error running game, Error : " << e.what() << std::endl;
+        timer->stop();
+        return;
+    }
 
     if (emulator.isDrawFlag()) {
-        repaint();
+        // keep sprites that are erased and drawn again before the next refresh on screen
+        Compositor::Frame frame = emulator.getPackedPixels();
+        for (std::size_t y = 0; y != frame.size(); y++)
+            drawn[y] |= frame[y];
         emulator.removeDrawFlag();
     }
     if (emulator.isSoundFlag()) {
@@ -76,6 +91,11 @@ void Game::runCycle() {
     }
 }
 
+void Game::refresh() {
+    compositor.push(drawn);
+    drawn = emulator.getPackedPixels();
+    update();
+}
 
 void Game::runGame(const QString& fileName) {
     Q_UNUSED(fileName);
@@ -126,30 +146,16 @@ void Game::setKey(QKeyEvent*& key, const uint8_t& setTo) {
 }
 
 void Game::paint() {
-    QTextStream cout(stdout);
     QPainter painter(this);
-    QColor color;
-    const std::array<std::array<uint8_t, WIDTH>, HEIGHT>& pixels = emulator.pixels;
-    painter.setPen(Qt::white);
-    painter.setBrush(Qt::white);
-    painter.drawRect(0, 0, WIDTH * 10, HEIGHT * 10);
-    painter.setPen(Qt::black);
-    painter.setBrush(Qt::black);
-    int enlargement = 10;
-    for(auto yIter = pixels.cbegin(); yIter != pixels.cend(); yIter++) {
-        for (auto xIter = yIter->cbegin(); xIter != yIter->cend(); xIter++) {
-            auto y = HEIGHT - static_cast<int>(std::distance(yIter, pixels.cend()));
-            auto x = WIDTH - static_cast<int>(std::distance(xIter, yIter->cend()));
-            uint8_t type = *xIter; // 0 -> white, 1 -> black
-            if (type == 0) {
-                painter.drawRect(x * enlargement, y * enlargement, enlargement, enlargement);
-            }
-        }
-    }
-
+    const std::vector<uint32_t>& pixels = compositor.compose();
+    QImage image(reinterpret_cast<const uchar*>(pixels.data()), static_cast<int>(compositor.width()),
+                 static_cast<int>(compositor.height()), QImage::Format_RGB32);
+    painter.drawImage(0, 0, image);
 }
 
 
 void Game::resetgame() {
     emulator.initalize();
+    compositor.clear();
+    drawn.fill(0);
 }
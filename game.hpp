@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QTimer>
 #include <Chip8.hpp>
+#include <Compositor.hpp>
 #include <QMediaPlayer>
 
 namespace Ui {
@@ -30,12 +31,18 @@ private slots:
     void runGame(const QString&);
 private:
     void runCycle();
+    void refresh();
     void setKey(QKeyEvent*& key, const uint8_t& setTo);
     Ui::Game *ui;
     QTimer* timer;
+    // paints at 60 Hz instead of on every draw of the program
+    QTimer* refreshTimer;
     QString filepath;
     QMediaPlayer* player;
     Chip8 emulator;
+    Compositor compositor;
+    // every pixel that was on at some point since the last refresh
+    Compositor::Frame drawn{};
 };
 
 #endif // GAME_HPP
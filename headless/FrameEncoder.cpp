@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "FrameEncoder.hpp"
+
+namespace {
+
+void writeLittleEndian(std::ofstream& ofs, uint32_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i != bytes; i++)
+        ofs.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+// Packs variable length codes least significant bit first into sub-blocks of at most 255 bytes
+class GifBitWriter {
+public:
+    explicit GifBitWriter(std::ofstream& ofs) : ofs(ofs) {}
+
+    void write(uint16_t code, unsigned size) {
+        bits |= static_cast<uint32_t>(code) << count;
+        count += size;
+        while (count >= 8) {
+            push(static_cast<uint8_t>(bits & 0xFF));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void flush() {
+        if (count > 0)
+            push(static_cast<uint8_t>(bits & 0xFF));
+        bits = 0;
+        count = 0;
+        if (!block.empty())
+            writeBlock();
+        ofs.put(0); // block terminator
+    }
+private:
+    void push(uint8_t byte) {
+        block.push_back(byte);
+        if (block.size() == 255)
+            writeBlock();
+    }
+
+    void writeBlock() {
+        ofs.put(static_cast<char>(block.size()));
+        ofs.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+        block.clear();
+    }
+
+    std::ofstream& ofs;
+    std::vector<uint8_t> block;
+    uint32_t bits = 0;
+    unsigned count = 0;
+};
+
+}
+
+std::unique_ptr<FrameEncoder> FrameEncoder::create(Format format, const std::string& path,
+                                                   uint32_t cyclesPerSecond, unsigned scale) {
+    if (format == Format::Gif)
+        return std::unique_ptr<FrameEncoder>(new GifEncoder(path, cyclesPerSecond, scale));
+    return std::unique_ptr<FrameEncoder>(new RawEncoder(path, cyclesPerSecond));
+}
+
+RawEncoder::RawEncoder(const std::string& path, uint32_t cyclesPerSecond)
+    : ofs(path, std::ios_base::out | std::ios_base::binary) {
+    if (!ofs.good())
+        throw std::runtime_error("Unable to open " + path + " for writing");
+    ofs.write("CH8V", 4);
+    ofs.put(1);
+    ofs.put(static_cast<char>(WIDTH));
+    ofs.put(static_cast<char>(HEIGHT));
+    ofs.put(0);
+    writeLittleEndian(ofs, cyclesPerSecond, 4);
+}
+
+void RawEncoder::write(const Frame& frame, uint64_t cycles) {
+    writeLittleEndian(ofs, static_cast<uint32_t>(std::min<uint64_t>(cycles, UINT32_MAX)), 4);
+    for (uint64_t row : frame) {
+        for (int shift = 56; shift >= 0; shift -= 8)
+            ofs.put(static_cast<char>((row >> shift) & 0xFF));
+    }
+}
+
+void RawEncoder::finish() {
+    ofs.flush();
+}
+
+GifEncoder::GifEncoder(const std::string& path, uint32_t cyclesPerSecond, unsigned scale)
+    : ofs(path, std::ios_base::out | std::ios_base::binary),
+      cyclesPerSecond(cyclesPerSecond == 0 ? 1 : cyclesPerSecond), scale(scale == 0 ? 1 : scale) {
+    if (!ofs.good())
+        throw std::runtime_error("Unable to open " + path + " for writing");
+
+    ofs.write("GIF89a", 6);
+    writeLittleEndian(ofs, WIDTH * this->scale, 2);
+    writeLittleEndian(ofs, HEIGHT * this->scale, 2);
+    ofs.put(static_cast<char>(0x80)); // global colour table of 2 entries
+    ofs.put(0); // background colour
+    ofs.put(0); // pixel aspect ratio
+    // 0 -> black, 1 -> white, the same colours Game paints
+    const char palette[6] = {0, 0, 0, static_cast<char>(0xFF), static_cast<char>(0xFF), static_cast<char>(0xFF)};
+    ofs.write(palette, sizeof(palette));
+
+    // loop forever
+    ofs.write("\x21\xFF\x0BNETSCAPE2.0\x03\x01\x00\x00\x00", 19);
+}
+
+void GifEncoder::write(const Frame& frame, uint64_t cycles) {
+    if (hasPending) {
+        uint64_t total = remainder + pendingCycles * 100;
+        uint64_t delay = total / cyclesPerSecond;
+        // most viewers show delays below 2 as 10, drop the frame and carry its time to the next one instead
+        if (delay >= 2) {
+            writeFrame(pending, static_cast<uint16_t>(std::min<uint64_t>(delay, UINT16_MAX)));
+            remainder = total % cyclesPerSecond;
+        }
+        else
+            remainder = total;
+    }
+    pending = frame;
+    pendingCycles = cycles;
+    hasPending = true;
+}
+
+uint64_t GifEncoder::minimumCycles() const {
+    return (2ull * cyclesPerSecond + 99) / 100;
+}
+
+void GifEncoder::finish() {
+    if (hasPending) {
+        uint64_t delay = (remainder + pendingCycles * 100) / cyclesPerSecond;
+        writeFrame(pending, static_cast<uint16_t>(std::min<uint64_t>(std::max<uint64_t>(delay, 2), UINT16_MAX)));
+        hasPending = false;
+    }
+    ofs.put(0x3B); // trailer
+    ofs.flush();
+}
+
+void GifEncoder::writeFrame(const Frame& frame, uint16_t delay) {
+    // graphic control extension holding the delay
+    ofs.write("\x21\xF9\x04\x00", 4);
+    writeLittleEndian(ofs, delay, 2);
+    ofs.put(0);
+    ofs.put(0);
+
+    // image descriptor covering the whole screen
+    ofs.put(0x2C);
+    writeLittleEndian(ofs, 0, 2);
+    writeLittleEndian(ofs, 0, 2);
+    writeLittleEndian(ofs, WIDTH * scale, 2);
+    writeLittleEndian(ofs, HEIGHT * scale, 2);
+    ofs.put(0);
+
+    std::vector<uint8_t> indices;
+    indices.reserve(WIDTH * HEIGHT * scale * scale);
+    for (uint64_t row : frame) {
+        for (unsigned repeatY = 0; repeatY != scale; repeatY++) {
+            for (int x = WIDTH - 1; x >= 0; x--) {
+                uint8_t pixel = (row >> x) & 1;
+                indices.insert(indices.end(), scale, pixel);
+            }
+        }
+    }
+    writeLzw(indices);
+}
+
+void GifEncoder::writeLzw(const std::vector<uint8_t>& indices) {
+    // the minimum code size of GIF is 2 bits even with a 2 colour palette
+    const unsigned minCodeSize = 2;
+    const uint16_t clearCode = 1 << minCodeSize;
+    const uint16_t endCode = clearCode + 1;
+    const uint16_t maxCode = 4095;
+    ofs.put(static_cast<char>(minCodeSize));
+
+    // children of every code, indexed by code * 4 + pixel, 0 means no entry as no code can point back to 0
+    std::vector<uint16_t> table(4096 * 4, 0);
+    GifBitWriter writer(ofs);
+    unsigned codeSize = minCodeSize + 1;
+    uint16_t lastCode = endCode;
+
+    writer.write(clearCode, codeSize);
+    uint16_t current = indices.empty() ? 0 : indices.front();
+    for (std::size_t i = 1; i < indices.size(); i++) {
+        uint8_t pixel = indices[i];
+        uint16_t& next = table[current * 4u + pixel];
+        if (next != 0) {
+            current = next;
+            continue;
+        }
+        writer.write(current, codeSize);
+        next = ++lastCode;
+        if (lastCode >= (1u << codeSize))
+            ++codeSize;
+        if (lastCode == maxCode) {
+            writer.write(clearCode, codeSize);
+            std::fill(table.begin(), table.end(), 0);
+            codeSize = minCodeSize + 1;
+            lastCode = endCode;
+        }
+        current = pixel;
+    }
+    writer.write(current, codeSize);
+    writer.write(endCode, codeSize);
+    writer.flush();
+}
@@ -0,0 +1,72 @@
+#ifndef FRAMEENCODER_HPP
+#define FRAMEENCODER_HPP
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Chip8.hpp"
+
+using Frame = std::array<uint64_t, HEIGHT>;
+
+// Writes a stream of frames, each frame is shown for a number of emulated cycles.
+class FrameEncoder {
+public:
+    enum class Format { Raw, Gif };
+
+    virtual ~FrameEncoder() = default;
+
+    virtual void write(const Frame& frame, uint64_t cycles) = 0;
+
+    // Frames shown for fewer cycles would be dropped by the encoder, 0 if every frame is written
+    virtual uint64_t minimumCycles() const { return 0; }
+
+    // Flush anything buffered and terminate the stream
+    virtual void finish() = 0;
+
+    static std::unique_ptr<FrameEncoder> create(Format format, const std::string& path,
+                                                uint32_t cyclesPerSecond, unsigned scale);
+};
+
+// Raw packed bitplanes, header :
+//   "CH8V", version (1 byte), width (1 byte), height (1 byte), 0, cycles per second (uint32 little endian)
+// followed by one record per frame :
+//   cycles shown (uint32 little endian), HEIGHT rows of 8 bytes, leftmost pixel in the most significant bit
+class RawEncoder : public FrameEncoder {
+public:
+    RawEncoder(const std::string& path, uint32_t cyclesPerSecond);
+
+    void write(const Frame& frame, uint64_t cycles) override;
+    void finish() override;
+private:
+    std::ofstream ofs;
+};
+
+// Animated GIF with a black and white palette, each pixel is enlarged to scale x scale.
+// GIF delays are in hundredths of a second, frames shown for less than the
+// minimum delay viewers honour are dropped and their time is carried over to the next frame.
+class GifEncoder : public FrameEncoder {
+public:
+    GifEncoder(const std::string& path, uint32_t cyclesPerSecond, unsigned scale);
+
+    void write(const Frame& frame, uint64_t cycles) override;
+    uint64_t minimumCycles() const override;
+    void finish() override;
+private:
+    void writeFrame(const Frame& frame, uint16_t delay);
+    void writeLzw(const std::vector<uint8_t>& indices);
+
+    std::ofstream ofs;
+    uint32_t cyclesPerSecond;
+    unsigned scale;
+    bool hasPending = false;
+    Frame pending{};
+    uint64_t pendingCycles = 0;
+    // cycles not yet converted to hundredths of a second, carried over so the animation does not drift
+    uint64_t remainder = 0;
+};
+
+#endif // FRAMEENCODER_HPP
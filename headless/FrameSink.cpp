@@ -0,0 +1,92 @@
+#include "FrameSink.hpp"
+
+FrameSink::FrameSink(std::unique_ptr<FrameEncoder> encoder, std::size_t capacity, bool lossless)
+    : encoder(std::move(encoder)), capacity(capacity == 0 ? 1 : capacity), lossless(lossless),
+      minimumCycles(this->encoder->minimumCycles()), worker(&FrameSink::encode, this) {
+}
+
+FrameSink::~FrameSink() {
+    if (worker.joinable())
+        finish(lastCycle);
+}
+
+void FrameSink::push(const Frame& frame, uint64_t cycle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.captured;
+        if (hasLast && frame == last) {
+            ++stats.duplicates;
+            return;
+        }
+    }
+    // the previous frame is only complete once we know how long it stayed on screen
+    if (hasLast) {
+        uint64_t cycles = carried + cycle - lastCycle;
+        if (cycles < minimumCycles) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.coalesced;
+            carried = cycles;
+        }
+        else {
+            enqueue(Entry{last, cycles}, lossless);
+            carried = 0;
+        }
+    }
+    last = frame;
+    lastCycle = cycle;
+    hasLast = true;
+}
+
+void FrameSink::finish(uint64_t cycle) {
+    if (hasLast) {
+        // the recording has to end on the last screen, wait for a slot even if frames may be dropped
+        enqueue(Entry{last, carried + cycle - lastCycle}, true);
+        hasLast = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    notEmpty.notify_one();
+    worker.join();
+    encoder->finish();
+}
+
+FrameSink::Stats FrameSink::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameSink::enqueue(const Entry& entry, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.size() >= capacity) {
+        if (!wait) {
+            // the frame before it stays on screen for that long instead, so the recording keeps its length
+            queue.back().cycles += entry.cycles;
+            ++stats.dropped;
+            return;
+        }
+        notFull.wait(lock, [this]() { return queue.size() < capacity; });
+    }
+    queue.push_back(entry);
+    lock.unlock();
+    notEmpty.notify_one();
+}
+
+void FrameSink::encode() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        notEmpty.wait(lock, [this]() { return finished || !queue.empty(); });
+        if (queue.empty())
+            return;
+        Entry entry = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+
+        encoder->write(entry.frame, entry.cycles);
+
+        lock.lock();
+        ++stats.written;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef FRAMESINK_HPP
+#define FRAMESINK_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "FrameEncoder.hpp"
+
+// Collects frames from the emulation loop and hands them to an encoder running on a background thread.
+// Identical consecutive frames are merged into one frame shown for longer before they reach the queue,
+// frames shown for less than FrameEncoder::minimumCycles() give their time to the next frame and never take a slot.
+// The queue is bounded, when the encoder falls behind new frames are dropped and their time is added
+// to the last queued frame (or the caller waits if the sink is lossless) so memory use stays fixed.
+class FrameSink {
+public:
+    struct Stats {
+        uint64_t captured = 0;
+        uint64_t duplicates = 0;
+        // shown too briefly for the encoder
+        uint64_t coalesced = 0;
+        uint64_t dropped = 0;
+        uint64_t written = 0;
+    };
+
+    FrameSink(std::unique_ptr<FrameEncoder> encoder, std::size_t capacity, bool lossless);
+    ~FrameSink();
+
+    FrameSink(const FrameSink&) = delete;
+    FrameSink& operator=(const FrameSink&) = delete;
+
+    // Capture the screen at the given emulated cycle
+    void push(const Frame& frame, uint64_t cycle);
+
+    // Queue the last frame, shown until the given cycle, and wait for the encoder to finish
+    void finish(uint64_t cycle);
+
+    Stats getStats() const;
+private:
+    struct Entry {
+        Frame frame;
+        uint64_t cycles;
+    };
+
+    // Queue the entry, waiting for a free slot or adding its time to the last queued entry when the queue is full
+    void enqueue(const Entry& entry, bool wait);
+    void encode();
+
+    std::unique_ptr<FrameEncoder> encoder;
+    std::size_t capacity;
+    bool lossless;
+    uint64_t minimumCycles;
+
+    // only touched by the emulation thread
+    bool hasLast = false;
+    Frame last{};
+    uint64_t lastCycle = 0;
+    // time of coalesced frames, added to the next frame queued
+    uint64_t carried = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<Entry> queue;
+    bool finished = false;
+    Stats stats;
+
+    std::thread worker;
+};
+
+#endif // FRAMESINK_HPP
@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "KeyScript.hpp"
+
+KeyScript::KeyScript(const std::string& script) : script(script.empty() ? "-" : script) {
+    if (this->script == "-")
+        return;
+
+    std::istringstream iss(script);
+    std::string press;
+    while (std::getline(iss, press, ',')) {
+        std::size_t at = press.find('@');
+        std::size_t dash = press.find('-', at);
+        if (at != 1 || dash == std::string::npos)
+            throw std::runtime_error("Invalid key press in script : " + press);
+
+        uint8_t key = static_cast<uint8_t>(std::stoul(press.substr(0, 1), nullptr, 16));
+        uint64_t start = std::stoull(press.substr(at + 1, dash - at - 1));
+        uint64_t end = std::stoull(press.substr(dash + 1));
+        if (end <= start)
+            throw std::runtime_error("Key press ends before it starts : " + press);
+        events.push_back(Event{start, key, true});
+        events.push_back(Event{end, key, false});
+    }
+    // releases go first so a key pressed again on the cycle it was released stays down
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.cycle < b.cycle || (a.cycle == b.cycle && !a.pressed && b.pressed);
+    });
+}
+
+void KeyScript::apply(Chip8& emulator, uint64_t cycle) {
+    while (next != events.size() && events[next].cycle <= cycle) {
+        emulator.setKey(events[next].key, events[next].pressed);
+        ++next;
+    }
+}
+
+const std::string& KeyScript::str() const noexcept {
+    return script;
+}
@@ -0,0 +1,34 @@
+#ifndef KEYSCRIPT_HPP
+#define KEYSCRIPT_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Chip8.hpp"
+
+// Scripted key presses for runs without a keyboard.
+// A script is a comma separated list of key@start-end, the key (hexadecimal 0-F) is held from cycle start
+// until cycle end, for example "4@1000-1500,6@2000-2600". "-" or an empty string is no input.
+class KeyScript {
+public:
+    KeyScript() = default;
+    explicit KeyScript(const std::string& script);
+
+    // Press and release the keys scheduled for the cycle about to run
+    void apply(Chip8& emulator, uint64_t cycle);
+
+    const std::string& str() const noexcept;
+private:
+    struct Event {
+        uint64_t cycle;
+        uint8_t key;
+        bool pressed;
+    };
+
+    std::string script;
+    std::vector<Event> events;
+    std::size_t next = 0;
+};
+
+#endif // KEYSCRIPT_HPP
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "Chip8.hpp"
+#include "Hash.hpp"
+#include "KeyScript.hpp"
+#include "Regression.hpp"
+
+namespace {
+
+// Hash of the packed rows, leftmost pixels first so it does not depend on the byte order of the machine
+uint64_t hashFrame(uint64_t hash, const std::array<uint64_t, HEIGHT>& frame) noexcept {
+    std::array<uint8_t, HEIGHT * 8> bytes;
+    for (std::size_t y = 0; y != HEIGHT; y++) {
+        for (std::size_t i = 0; i != 8; i++)
+            bytes[y * 8 + i] = static_cast<uint8_t>(frame[y] >> (56 - 8 * i));
+    }
+    return Hash::fnv1a(bytes.data(), bytes.size(), hash);
+}
+
+}
+
+Regression::Regression(const std::string& goldenPath) : goldenPath(goldenPath) {
+    std::size_t slash = goldenPath.find_last_of('/');
+    directory = slash == std::string::npos ? "." : goldenPath.substr(0, slash);
+
+    std::ifstream ifs(goldenPath);
+    if (!ifs.good())
+        throw std::runtime_error("Unable to read golden file " + goldenPath);
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        lines.push_back(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        Case test;
+        std::istringstream iss(line);
+        if (!(iss >> test.rom >> test.cycles >> test.seed >> test.keys))
+            throw std::runtime_error("Invalid line in golden file : " + line);
+        std::string field;
+        while (iss >> field)
+            test.expected += (test.expected.empty() ? "" : " ") + field;
+
+        caseLines.push_back(lines.size() - 1);
+        cases.push_back(test);
+    }
+}
+
+std::size_t Regression::verify(unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    runAll(threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t failures = 0;
+    for (const Case& test : cases) {
+        bool passed = !test.expected.empty() && test.expected == test.actual;
+        std::cout << (passed ? "ok     " : "FAILED ") << test.rom << ' ' << test.cycles << ' '
+                  << test.seed << ' ' << test.keys << '\n';
+        if (!passed) {
+            std::cout << "  expected : " << (test.expected.empty() ? "(no golden)" : test.expected) << '\n'
+                      << "  actual   : " << test.actual << '\n';
+            ++failures;
+        }
+    }
+    std::cout << cases.size() - failures << '/' << cases.size() << " passed in " << seconds << 's' << std::endl;
+    return failures;
+}
+
+void Regression::update(unsigned threads) {
+    runAll(threads);
+    for (std::size_t i = 0; i != cases.size(); i++) {
+        const Case& test = cases[i];
+        std::ostringstream line;
+        line << test.rom << ' ' << test.cycles << ' ' << test.seed << ' ' << test.keys << ' ' << test.actual;
+        lines[caseLines[i]] = line.str();
+    }
+
+    std::ofstream ofs(goldenPath);
+    for (const std::string& line : lines)
+        ofs << line << '\n';
+    if (!ofs.good())
+        throw std::runtime_error("Unable to write golden file " + goldenPath);
+    std::cout << "Updated " << cases.size() << " cases in " << goldenPath << std::endl;
+}
+
+void Regression::runAll(unsigned threads) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(cases.size())));
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < cases.size(); i = next++)
+            cases[i].actual = run(cases[i]);
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+}
+
+std::string Regression::run(const Case& test) const {
+    try {
+        Chip8 emulator;
+        emulator.setLogging(false);
+        emulator.seedRandom(test.seed);
+        emulator.loadGame(directory + '/' + test.rom);
+        KeyScript keys(test.keys);
+
+        uint64_t trace = Hash::fnvOffset;
+        for (uint64_t cycle = 0; cycle != test.cycles; cycle++) {
+            keys.apply(emulator, cycle);
+            emulator.emulateCycle();
+            if (emulator.isDrawFlag()) {
+                trace = hashFrame(trace, emulator.getPackedPixels());
+                emulator.removeDrawFlag();
+            }
+            emulator.removeSoundFlag();
+        }
+
+        std::ostringstream result;
+        result << std::hex << std::setfill('0')
+               << "frame=" << std::setw(16) << hashFrame(Hash::fnvOffset, emulator.getPackedPixels())
+               << " trace=" << std::setw(16) << trace
+               << " pc=" << std::setw(3) << emulator.getProgramCounter()
+               << " i=" << std::setw(3) << emulator.getIndexRegister() << " v=";
+        for (uint8_t v : emulator.getRegisters())
+            result << std::setw(2) << static_cast<unsigned>(v);
+        return result.str();
+    } catch (const std::exception& e) {
+        return std::string("error=") + e.what();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef REGRESSION_HPP
+#define REGRESSION_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Golden image regression suite.
+// Each line of a golden file describes one run and the state expected at its end :
+//   <ROM> <cycles> <seed> <key script> frame=<hash> trace=<hash> pc=<PC> i=<I> v=<V0-VF>
+// ROM paths are relative to the golden file, the key script uses the KeyScript syntax.
+// frame is the hash of the final screen, trace chains the hash of every screen the program drew.
+// Lines starting with # are comments, a line with only the first four fields is filled in by update().
+class Regression {
+public:
+    explicit Regression(const std::string& goldenPath);
+
+    // Run every case on the given number of threads, returns the number of failed cases
+    std::size_t verify(unsigned threads);
+
+    // Run every case and rewrite the golden file with the results
+    void update(unsigned threads);
+private:
+    struct Case {
+        std::string rom;
+        uint64_t cycles = 0;
+        uint32_t seed = 0;
+        std::string keys;
+        std::string expected;
+        std::string actual;
+    };
+
+    void runAll(unsigned threads);
+    std::string run(const Case& test) const;
+
+    std::string goldenPath;
+    std::string directory;
+    // the file as read, comments are kept when it is rewritten
+    std::vector<std::string> lines;
+    // index into lines of every case
+    std::vector<std::size_t> caseLines;
+    std::vector<Case> cases;
+};
+
+#endif // REGRESSION_HPP
@@ -0,0 +1,30 @@
+TEMPLATE = app
+TARGET = Chip-8-headless
+
+# Runs ROMs without the GUI, only the interpreter core is needed.
+QT -= core gui
+CONFIG += console c++14 thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++14
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    FrameEncoder.cpp \
+    FrameSink.cpp \
+    KeyScript.cpp \
+    Regression.cpp \
+    ../Chip8.cpp \
+    ../DecodeCache.cpp \
+    ../RomAnalysis.cpp
+
+HEADERS += \
+    FrameEncoder.hpp \
+    FrameSink.hpp \
+    KeyScript.hpp \
+    Regression.hpp \
+    ../Chip8.hpp \
+    ../DecodeCache.hpp \
+    ../Hash.hpp \
+    ../RomAnalysis.hpp
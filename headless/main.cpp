@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "Chip8.hpp"
+#include "DecodeCache.hpp"
+#include "FrameSink.hpp"
+#include "KeyScript.hpp"
+#include "Regression.hpp"
+
+namespace {
+
+struct Options {
+    std::string rom;
+    uint64_t cycles = 60000;
+    std::string output;
+    FrameEncoder::Format format = FrameEncoder::Format::Raw;
+    bool formatSet = false;
+    // 0 captures whenever the program draws, otherwise every N cycles
+    uint64_t captureEvery = 0;
+    // Game runs one cycle every millisecond
+    uint32_t cyclesPerSecond = 1000;
+    unsigned scale = 4;
+    std::size_t queueCapacity = 256;
+    bool lossless = false;
+    uint32_t seed = 0;
+    std::string keys;
+    std::string cacheDirectory;
+    std::string goldens;
+    bool updateGoldens = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+void usage(const char* program) {
+    std::cerr << "Usage : " << program << " [options] <ROM>\n"
+              << "        " << program << " [-j <threads>] -g|-G <golden file>\n"
+              << "  -c <cycles>   cycles to run (default : 60000)\n"
+              << "  -o <file>     record the screen into file\n"
+              << "  -f raw|gif    recording format (default : from the file extension, otherwise raw)\n"
+              << "  -r <cycles>   capture every N cycles instead of whenever the program draws,\n"
+              << "                16 is about 60 Hz at the default speed\n"
+              << "  -p <cycles>   emulated cycles per second, used for GIF delays (default : 1000)\n"
+              << "  -x <scale>    GIF pixel size (default : 4)\n"
+              << "  -q <frames>   frames queued for the encoder (default : 256)\n"
+              << "  -w            wait for the encoder instead of dropping frames when the queue is full\n"
+              << "  -s <seed>     seed of the random number generator\n"
+              << "  -a <dir>      analyse the ROM through the decode cache in dir and report it\n"
+              << "  -k <script>   scripted key presses, key@start-end separated by commas (e.g. 4@100-900)\n"
+              << "  -g <file>     run the cases of a golden file and compare the results\n"
+              << "  -G <file>     run the cases of a golden file and write the results into it\n"
+              << "  -j <threads>  threads running golden cases (default : number of cores)\n";
+}
+
+bool parse(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-w") {
+            options.lossless = true;
+        }
+        else if (arg.size() == 2 && arg[0] == '-' && i + 1 < argc) {
+            std::string value = argv[++i];
+            switch (arg[1]) {
+            case 'c': options.cycles = std::strtoull(value.c_str(), nullptr, 10); break;
+            case 'o': options.output = value; break;
+            case 'f':
+                if (value != "raw" && value != "gif")
+                    return false;
+                options.format = value == "gif" ? FrameEncoder::Format::Gif : FrameEncoder::Format::Raw;
+                options.formatSet = true;
+                break;
+            case 'r': options.captureEvery = std::strtoull(value.c_str(), nullptr, 10); break;
+            case 'p': options.cyclesPerSecond = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10)); break;
+            case 'x': options.scale = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)); break;
+            case 'q': options.queueCapacity = std::strtoull(value.c_str(), nullptr, 10); break;
+            case 's': options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10)); break;
+            case 'k': options.keys = value; break;
+            case 'a': options.cacheDirectory = value; break;
+            case 'g': options.goldens = value; break;
+            case 'G': options.goldens = value; options.updateGoldens = true; break;
+            case 'j': options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)); break;
+            default: return false;
+            }
+        }
+        else if (arg[0] != '-' && options.rom.empty())
+            options.rom = arg;
+        else
+            return false;
+    }
+
+    if (!options.formatSet && options.output.size() >= 4 &&
+            options.output.compare(options.output.size() - 4, 4, ".gif") == 0)
+        options.format = FrameEncoder::Format::Gif;
+    return options.rom.empty() != options.goldens.empty();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!options.goldens.empty()) {
+        try {
+            Regression regression(options.goldens);
+            if (options.updateGoldens) {
+                regression.update(options.threads);
+                return 0;
+            }
+            return regression.verify(options.threads) == 0 ? 0 : 2;
+        } catch (const std::exception& e) {
+            std::cerr << "Error running " << options.goldens << ", Error : " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        std::ifstream ifs(options.rom, std::ios_base::in | std::ios_base::binary);
+        if (!ifs.good())
+            throw std::runtime_error("File does not exist");
+        std::vector<uint8_t> rom((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        Chip8 emulator;
+        emulator.seedRandom(options.seed);
+        emulator.loadGame(rom);
+        KeyScript keys(options.keys);
+
+        if (!options.cacheDirectory.empty()) {
+            DecodeCache::Stats stats;
+            RomAnalysis analysis = DecodeCache(options.cacheDirectory).load(rom, stats);
+            std::cout << "Analysis " << (stats.hit ? "read from cache" : "computed") << " in " << stats.seconds * 1e6
+                      << "us : " << analysis.instructions.size() << " instructions, " << analysis.blockStarts.size()
+                      << " basic blocks, quirk sensitive opcodes : " << analysis.describeQuirkOpcodes() << std::endl;
+            if (!stats.writeError.empty())
+                std::cerr << "Analysis not cached, Error : " << stats.writeError << std::endl;
+        }
+
+        std::unique_ptr<FrameSink> sink;
+        if (!options.output.empty()) {
+            sink.reset(new FrameSink(FrameEncoder::create(options.format, options.output, options.cyclesPerSecond, options.scale),
+                                     options.queueCapacity, options.lossless));
+            sink->push(emulator.getPackedPixels(), 0);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t cycle = 0;
+        while (cycle != options.cycles) {
+            keys.apply(emulator, cycle);
+            emulator.emulateCycle();
+            ++cycle;
+
+            bool capture = options.captureEvery == 0 ? emulator.isDrawFlag() : cycle % options.captureEvery == 0;
+            if (sink && capture)
+                sink->push(emulator.getPackedPixels(), cycle);
+            emulator.removeDrawFlag();
+            emulator.removeSoundFlag();
+        }
+        double emulated = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << cycle << " cycles in " << emulated << "s";
+        if (sink) {
+            sink->finish(cycle);
+            FrameSink::Stats stats = sink->getStats();
+            double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << ", " << stats.captured << " frames captured, " << stats.duplicates << " duplicates, "
+                      << stats.coalesced << " coalesced, "
+                      << stats.dropped << " dropped, " << stats.written << " written to " << options.output
+                      << " (" << total << "s with encoding)";
+        }
+        std::cout << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error running " << options.rom << ", Error : " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Messages between the session server and its clients.
+// Every message is : type (1 byte), payload length (uint16 little endian), payload.
+//
+// Client to server :
+//   'R' ROM image, resets the session and starts running it
+//   'K' key event : key (0x0 - 0xF), 1 pressed or 0 released
+//
+// Server to client :
+//   'F' screen update, only rows that changed since the previous update are sent,
+//       the first update after 'R' holds every row as the client may still show the previous ROM :
+//       frame number (uint32 little endian), changed rows (uint32 little endian, bit y is row y),
+//       encoding (1 byte), then the changed rows, 8 bytes each with the leftmost pixel in the most significant bit.
+//       With the RLE encoding the row bytes are compressed as pairs of count (1 - 255) and byte.
+//   'S' the sound timer expired, play a beep
+//   'E' error text, the session stopped running
+namespace Protocol {
+
+const uint8_t loadRom = 'R';
+const uint8_t key = 'K';
+
+const uint8_t frame = 'F';
+const uint8_t sound = 'S';
+const uint8_t error = 'E';
+
+const uint8_t encodingRaw = 0;
+const uint8_t encodingRle = 1;
+
+const std::size_t headerSize = 3;
+const std::size_t maxPayload = 0xFFFF;
+
+}
+
+#endif // PROTOCOL_HPP
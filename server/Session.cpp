@@ -0,0 +1,204 @@
+#include <cerrno>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Protocol.hpp"
+#include "Session.hpp"
+
+namespace {
+
+void appendLittleEndian(std::vector<uint8_t>& out, uint32_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i != bytes; i++)
+        out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+}
+
+// Pairs of count and byte, rows are mostly empty so long runs of 0 are common
+void appendRle(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes) {
+    for (std::size_t i = 0; i < bytes.size();) {
+        std::size_t run = 1;
+        while (i + run < bytes.size() && run < 255 && bytes[i + run] == bytes[i])
+            ++run;
+        out.push_back(static_cast<uint8_t>(run));
+        out.push_back(bytes[i]);
+        i += run;
+    }
+}
+
+}
+
+Session::Session(int fd) : fd(fd) {
+    emulator.setLogging(false);
+}
+
+Session::~Session() {
+    close(fd);
+}
+
+int Session::getFd() const noexcept {
+    return fd;
+}
+
+bool Session::receive() {
+    // a single read per wake up, a client that never stops writing can not hold up the other sessions
+    // of the loop, and only the part of one message that is still incomplete stays buffered
+    uint8_t buffer[4096];
+    ssize_t received;
+    do {
+        received = recv(fd, buffer, sizeof(buffer), 0);
+    } while (received < 0 && errno == EINTR);
+    if (received == 0)
+        return false;
+    if (received > 0)
+        input.insert(input.end(), buffer, buffer + received);
+    else if (errno != EAGAIN && errno != EWOULDBLOCK)
+        return false;
+
+    std::size_t offset = 0;
+    while (input.size() - offset >= Protocol::headerSize) {
+        std::size_t size = input[offset + 1] | (static_cast<std::size_t>(input[offset + 2]) << 8);
+        if (input.size() - offset < Protocol::headerSize + size)
+            break;
+        if (!handleMessage(input[offset], input.data() + offset + Protocol::headerSize, size))
+            return false;
+        offset += Protocol::headerSize + size;
+    }
+    input.erase(input.begin(), input.begin() + static_cast<long>(offset));
+    return true;
+}
+
+bool Session::handleMessage(uint8_t type, const uint8_t* payload, std::size_t size) {
+    switch (type) {
+    case Protocol::loadRom:
+        emulator.initalize();
+        emulator.removeDrawFlag();
+        emulator.removeSoundFlag();
+        try {
+            emulator.loadGame(std::vector<uint8_t>(payload, payload + size));
+        } catch (const std::exception& e) {
+            stop(e.what());
+            return true;
+        }
+        sentAll = false;
+        frameNumber = 0;
+        running = true;
+        return true;
+    case Protocol::key:
+        if (size != 2 || payload[0] > 0xF)
+            return false;
+        emulator.setKey(payload[0], payload[1] != 0);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void Session::tick(unsigned cycles, bool rle, std::size_t maxOutput) {
+    if (!running)
+        return;
+
+    try {
+        bool sound = false;
+        for (unsigned i = 0; i != cycles; i++) {
+            emulator.emulateCycle();
+            if (emulator.isSoundFlag()) {
+                sound = true;
+                emulator.removeSoundFlag();
+            }
+        }
+        if (sound)
+            sendMessage(Protocol::sound, {});
+    } catch (const std::exception& e) {
+        stop(e.what());
+        return;
+    }
+
+    // the screen is only compared once per frame, the draw flag is not needed
+    emulator.removeDrawFlag();
+    ++frameNumber;
+    if (output.size() - outputOffset <= maxOutput)
+        sendFrame(rle);
+}
+
+void Session::sendFrame(bool rle) {
+    Frame frame = emulator.getPackedPixels();
+    uint32_t changed = 0;
+    std::vector<uint8_t> rows;
+    for (std::size_t y = 0; y != HEIGHT; y++) {
+        if (sentAll && frame[y] == sent[y])
+            continue;
+        changed |= 1u << y;
+        for (int shift = 56; shift >= 0; shift -= 8)
+            rows.push_back(static_cast<uint8_t>((frame[y] >> shift) & 0xFF));
+    }
+    if (changed == 0)
+        return;
+    sent = frame;
+    sentAll = true;
+
+    std::vector<uint8_t> payload;
+    payload.reserve(9 + rows.size());
+    appendLittleEndian(payload, frameNumber, 4);
+    appendLittleEndian(payload, changed, 4);
+
+    std::vector<uint8_t> compressed;
+    if (rle)
+        appendRle(compressed, rows);
+    if (rle && compressed.size() < rows.size()) {
+        payload.push_back(Protocol::encodingRle);
+        payload.insert(payload.end(), compressed.cbegin(), compressed.cend());
+    }
+    else {
+        payload.push_back(Protocol::encodingRaw);
+        payload.insert(payload.end(), rows.cbegin(), rows.cend());
+    }
+    sendMessage(Protocol::frame, payload);
+    ++framesSent;
+}
+
+void Session::sendMessage(uint8_t type, const std::vector<uint8_t>& payload) {
+    // drop what was already written so the buffer does not grow forever
+    if (outputOffset == output.size()) {
+        output.clear();
+        outputOffset = 0;
+    }
+    output.push_back(type);
+    appendLittleEndian(output, static_cast<uint32_t>(payload.size()), 2);
+    output.insert(output.end(), payload.cbegin(), payload.cend());
+}
+
+void Session::stop(const std::string& reason) {
+    running = false;
+    sendMessage(Protocol::error, std::vector<uint8_t>(reason.cbegin(), reason.cend()));
+}
+
+bool Session::hasOutput() const noexcept {
+    return outputOffset != output.size();
+}
+
+bool Session::flush() {
+    while (hasOutput()) {
+        ssize_t written = send(fd, output.data() + outputOffset, output.size() - outputOffset, MSG_NOSIGNAL);
+        if (written >= 0) {
+            outputOffset += static_cast<std::size_t>(written);
+            bytesSent += static_cast<uint64_t>(written);
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return true;
+        if (errno != EINTR)
+            return false;
+    }
+    output.clear();
+    outputOffset = 0;
+    return true;
+}
+
+uint64_t Session::getBytesSent() const noexcept {
+    return bytesSent;
+}
+
+uint64_t Session::getFramesSent() const noexcept {
+    return framesSent;
+}
@@ -0,0 +1,64 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Chip8.hpp"
+
+// One client connection and the emulator it plays.
+// Input from the socket is buffered until whole messages arrive, output is buffered until the socket accepts it.
+class Session {
+public:
+    explicit Session(int fd);
+    ~Session();
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    int getFd() const noexcept;
+
+    // Read what the client sent, at most one buffer per call so the rest waits for the next poll,
+    // returns false once the connection is closed or the client misbehaved
+    bool receive();
+
+    // Run the emulator for a frame and queue the rows of the screen that changed.
+    // The update is skipped while more than maxOutput bytes are waiting to be sent,
+    // the next update then covers everything that changed since the last one sent.
+    void tick(unsigned cycles, bool rle, std::size_t maxOutput);
+
+    bool hasOutput() const noexcept;
+
+    // Write as much of the queued output as the socket accepts, returns false if the connection failed
+    bool flush();
+
+    uint64_t getBytesSent() const noexcept;
+    uint64_t getFramesSent() const noexcept;
+private:
+    using Frame = std::array<uint64_t, HEIGHT>;
+
+    bool handleMessage(uint8_t type, const uint8_t* payload, std::size_t size);
+    void sendMessage(uint8_t type, const std::vector<uint8_t>& payload);
+    void sendFrame(bool rle);
+    void stop(const std::string& reason);
+
+    int fd;
+    Chip8 emulator;
+    bool running = false;
+
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    std::size_t outputOffset = 0;
+
+    // the screen as the client knows it, unknown until the first update after a ROM is loaded
+    Frame sent{};
+    bool sentAll = false;
+    uint32_t frameNumber = 0;
+
+    uint64_t bytesSent = 0;
+    uint64_t framesSent = 0;
+};
+
+#endif // SESSION_HPP
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Session.hpp"
+#include "SessionServer.hpp"
+
+namespace {
+
+void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        throw std::runtime_error(std::string("Unable to make socket non blocking : ") + std::strerror(errno));
+}
+
+}
+
+SessionServer::SessionServer(const Options& options) : options(options) {
+    if (this->options.threads == 0)
+        this->options.threads = 1;
+    if (this->options.framesPerSecond == 0)
+        this->options.framesPerSecond = 60;
+
+    int result;
+    if (!options.unixPath.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.unixPath.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Unix socket path is too long");
+        std::strcpy(address.sun_path, options.unixPath.c_str());
+        unlink(options.unixPath.c_str());
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        result = listenFd < 0 ? -1 : bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    else {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options.port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (listenFd >= 0)
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        result = listenFd < 0 ? -1 : bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+
+    if (result < 0 || listen(listenFd, SOMAXCONN) < 0) {
+        std::string error = std::strerror(errno);
+        if (listenFd >= 0)
+            close(listenFd);
+        throw std::runtime_error("Unable to listen for clients : " + error);
+    }
+    setNonBlocking(listenFd);
+
+    for (unsigned i = 0; i != this->options.threads; i++)
+        loopStats.emplace_back(new LoopStats());
+}
+
+SessionServer::~SessionServer() {
+    close(listenFd);
+    if (!options.unixPath.empty())
+        unlink(options.unixPath.c_str());
+}
+
+void SessionServer::run() {
+    std::vector<std::thread> loops;
+    for (auto& stats : loopStats)
+        loops.emplace_back(&SessionServer::loop, this, std::ref(*stats));
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    uint64_t lastBytes = 0, lastFrames = 0, lastBusy = 0;
+    while (!stopped) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        if (options.statsInterval == 0 || now - last < std::chrono::seconds(options.statsInterval))
+            continue;
+
+        uint64_t sessions = 0, bytes = 0, frames = 0, busy = 0;
+        for (const auto& stats : loopStats) {
+            sessions += stats->sessions;
+            bytes += stats->bytesSent;
+            frames += stats->framesSent;
+            busy += stats->busyNanoseconds;
+        }
+        printStats(std::chrono::duration<double>(now - last).count(), sessions,
+                   bytes - lastBytes, frames - lastFrames, busy - lastBusy);
+        last = now;
+        lastBytes = bytes;
+        lastFrames = frames;
+        lastBusy = busy;
+    }
+
+    for (auto& loop : loops)
+        loop.join();
+}
+
+void SessionServer::stop() noexcept {
+    stopped = true;
+}
+
+void SessionServer::loop(LoopStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    const auto frameTime = std::chrono::nanoseconds(1000000000 / options.framesPerSecond);
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<pollfd> fds;
+    uint64_t closedBytes = 0, closedFrames = 0;
+    auto nextFrame = Clock::now() + frameTime;
+
+    while (!stopped) {
+        fds.clear();
+        fds.push_back(pollfd{listenFd, POLLIN, 0});
+        for (const auto& session : sessions)
+            fds.push_back(pollfd{session->getFd(), static_cast<short>(POLLIN | (session->hasOutput() ? POLLOUT : 0)), 0});
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - Clock::now()).count();
+        // wake up regularly so stop() is noticed
+        int timeout = static_cast<int>(std::min<long long>(std::max<long long>(wait, 0), 100));
+        if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+            std::cerr << "poll failed : " << std::strerror(errno) << std::endl;
+            stop();
+            break;
+        }
+        auto busyStart = Clock::now();
+
+        std::vector<bool> closed(sessions.size(), false);
+        for (std::size_t i = 0; i != sessions.size(); i++) {
+            short events = fds[i + 1].revents;
+            if ((events & POLLIN) && !sessions[i]->receive())
+                closed[i] = true;
+            else if (events & (POLLERR | POLLHUP | POLLNVAL))
+                closed[i] = true;
+            else if ((events & POLLOUT) && !sessions[i]->flush())
+                closed[i] = true;
+        }
+
+        // only take one client per wake up so new sessions spread over the loops
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            int flags = fd < 0 ? -1 : fcntl(fd, F_GETFL, 0);
+            if (fd >= 0 && (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+                close(fd);
+                fd = -1;
+            }
+            if (fd >= 0) {
+                // no effect on Unix sockets
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                sessions.emplace_back(new Session(fd));
+                closed.push_back(false);
+            }
+        }
+
+        auto now = Clock::now();
+        if (now >= nextFrame) {
+            for (std::size_t i = 0; i != sessions.size(); i++) {
+                if (closed[i])
+                    continue;
+                sessions[i]->tick(options.cyclesPerFrame, options.rle, options.maxOutput);
+                if (sessions[i]->hasOutput() && !sessions[i]->flush())
+                    closed[i] = true;
+            }
+            nextFrame += frameTime;
+            // when the loop falls behind skip frames instead of running them in a burst
+            if (now - nextFrame > frameTime * 4)
+                nextFrame = now + frameTime;
+        }
+
+        uint64_t bytes = closedBytes, frames = closedFrames;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i != sessions.size(); i++) {
+            bytes += sessions[i]->getBytesSent();
+            frames += sessions[i]->getFramesSent();
+            if (closed[i]) {
+                closedBytes += sessions[i]->getBytesSent();
+                closedFrames += sessions[i]->getFramesSent();
+                sessions[i].reset();
+            }
+            else
+                sessions[kept++] = std::move(sessions[i]);
+        }
+        sessions.resize(kept);
+
+        stats.sessions = sessions.size();
+        stats.bytesSent = bytes;
+        stats.framesSent = frames;
+        stats.busyNanoseconds += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - busyStart).count());
+    }
+}
+
+void SessionServer::printStats(double seconds, uint64_t sessions, uint64_t bytes, uint64_t frames, uint64_t busy) const {
+    // busy time over wall time is the number of cores the loops kept busy
+    double cores = static_cast<double>(busy) / 1e9 / seconds;
+    double bytesPerSecond = static_cast<double>(bytes) / seconds;
+    std::cout << std::fixed << std::setprecision(1)
+              << "sessions: " << sessions
+              << " updates/s: " << static_cast<double>(frames) / seconds
+              << " bytes/s: " << bytesPerSecond
+              << " per session: " << (sessions != 0 ? bytesPerSecond / static_cast<double>(sessions) : 0.0)
+              << " cores busy: " << std::setprecision(3) << cores
+              << " sessions per core: " << std::setprecision(0) << (cores > 0 ? static_cast<double>(sessions) / cores : 0.0)
+              << std::endl;
+}
@@ -0,0 +1,59 @@
+#ifndef SESSIONSERVER_HPP
+#define SESSIONSERVER_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Hosts CHIP-8 sessions for remote clients over a Unix socket or TCP on the loopback interface.
+// Every thread runs an event loop that accepts connections from the shared listening socket
+// and emulates its sessions frame by frame, so sessions are spread across the threads.
+class SessionServer {
+public:
+    struct Options {
+        // a Unix socket is used when set, otherwise TCP on 127.0.0.1
+        std::string unixPath;
+        uint16_t port = 6464;
+        unsigned threads = 1;
+        // Game runs a cycle every millisecond, 16 cycles is about one frame at 60 Hz
+        unsigned cyclesPerFrame = 16;
+        unsigned framesPerSecond = 60;
+        bool rle = false;
+        // bytes waiting for a slow client before screen updates are held back
+        std::size_t maxOutput = 1 << 16;
+        // seconds between statistics, 0 to disable them
+        unsigned statsInterval = 5;
+    };
+
+    explicit SessionServer(const Options& options);
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    // Serve until stop() is called
+    void run();
+
+    // Can be called from any thread or a signal handler
+    void stop() noexcept;
+private:
+    struct LoopStats {
+        std::atomic<uint64_t> sessions{0};
+        std::atomic<uint64_t> bytesSent{0};
+        std::atomic<uint64_t> framesSent{0};
+        // time spent emulating and writing, the rest of the time the loop waits for the next frame
+        std::atomic<uint64_t> busyNanoseconds{0};
+    };
+
+    void loop(LoopStats& stats);
+    void printStats(double seconds, uint64_t sessions, uint64_t bytes, uint64_t frames, uint64_t busy) const;
+
+    Options options;
+    int listenFd = -1;
+    std::atomic<bool> stopped{false};
+    std::vector<std::unique_ptr<LoopStats>> loopStats;
+};
+
+#endif // SESSIONSERVER_HPP
@@ -0,0 +1,22 @@
+TEMPLATE = app
+TARGET = Chip-8-server-check
+
+# Plays ROMs through a local server as a client and checks the screen updates.
+QT -= core gui
+CONFIG += console c++14 thread
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -std=c++14
+
+INCLUDEPATH += .. ../..
+
+SOURCES += main.cpp \
+    ../Session.cpp \
+    ../SessionServer.cpp \
+    ../../Chip8.cpp
+
+HEADERS += \
+    ../Protocol.hpp \
+    ../Session.hpp \
+    ../SessionServer.hpp \
+    ../../Chip8.hpp
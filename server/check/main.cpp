@@ -0,0 +1,187 @@
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Chip8.hpp"
+#include "Protocol.hpp"
+#include "SessionServer.hpp"
+
+// Starts a server on a Unix socket, plays a few ROMs through it as a client would
+// and checks the screen rebuilt from the row updates. Returns 0 if every check passed.
+
+namespace {
+
+using Screen = std::array<uint64_t, HEIGHT>;
+
+// Draws 0 in the top left corner, waits for a key and draws that key's digit instead
+const std::vector<uint8_t> keyRom = {
+    0x60, 0x00, // V0 = 0
+    0x61, 0x00, // V1 = 0
+    0xF0, 0x29, // I = glyph of V0
+    0xD1, 0x15, // draw at V1, V1
+    0xF2, 0x0A, // V2 = next key
+    0x00, 0xE0, // clear
+    0xF2, 0x29, // I = glyph of V2
+    0xD1, 0x15, // draw at V1, V1
+    0x12, 0x10  // loop
+};
+const std::vector<uint8_t> idleRom = {0x12, 0x00};
+const std::vector<uint8_t> returnRom = {0x00, 0xEE};
+
+Screen glyph(const std::array<uint8_t, 5>& rows) {
+    Screen screen{};
+    for (std::size_t y = 0; y != rows.size(); y++)
+        screen[y] = static_cast<uint64_t>(rows[y]) << 56;
+    return screen;
+}
+
+class Client {
+public:
+    explicit Client(const std::string& path) : fd(socket(AF_UNIX, SOCK_STREAM, 0)) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            if (fd >= 0)
+                close(fd);
+            throw std::runtime_error("Unable to connect to " + path);
+        }
+        // wake up regularly so waitFor() notices its deadline
+        timeval timeout{0, 100000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~Client() {
+        close(fd);
+    }
+
+    void send(uint8_t type, const std::vector<uint8_t>& payload) {
+        std::vector<uint8_t> message = {type, static_cast<uint8_t>(payload.size()), static_cast<uint8_t>(payload.size() >> 8)};
+        message.insert(message.end(), payload.cbegin(), payload.cend());
+        if (::send(fd, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size()))
+            throw std::runtime_error("Unable to send to the server");
+    }
+
+    // Read messages until the condition holds, false if it did not within a second
+    bool waitFor(const std::function<bool()>& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            uint8_t buffer[4096];
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received == 0)
+                return false;
+            if (received > 0) {
+                input.insert(input.end(), buffer, buffer + received);
+                parse();
+            }
+        }
+        return true;
+    }
+
+    Screen screen{};
+    std::string error;
+private:
+    void parse() {
+        std::size_t offset = 0;
+        while (input.size() - offset >= Protocol::headerSize) {
+            std::size_t size = input[offset + 1] | (static_cast<std::size_t>(input[offset + 2]) << 8);
+            if (input.size() - offset < Protocol::headerSize + size)
+                break;
+            const uint8_t* payload = input.data() + offset + Protocol::headerSize;
+            if (input[offset] == Protocol::frame)
+                applyFrame(payload, size);
+            else if (input[offset] == Protocol::error)
+                error.assign(payload, payload + size);
+            offset += Protocol::headerSize + size;
+        }
+        input.erase(input.begin(), input.begin() + static_cast<long>(offset));
+    }
+
+    void applyFrame(const uint8_t* payload, std::size_t size) {
+        uint32_t changed = payload[4] | payload[5] << 8 | payload[6] << 16 | static_cast<uint32_t>(payload[7]) << 24;
+        std::vector<uint8_t> rows;
+        if (payload[8] == Protocol::encodingRle) {
+            for (std::size_t i = 9; i + 1 < size; i += 2)
+                rows.insert(rows.end(), payload[i], payload[i + 1]);
+        }
+        else
+            rows.assign(payload + 9, payload + size);
+
+        std::size_t next = 0;
+        for (std::size_t y = 0; y != HEIGHT; y++) {
+            if (!(changed & (1u << y)))
+                continue;
+            uint64_t row = 0;
+            for (std::size_t i = 0; i != 8; i++)
+                row = row << 8 | rows.at(next++);
+            screen[y] = row;
+        }
+    }
+
+    int fd;
+    std::vector<uint8_t> input;
+};
+
+bool check(bool passed, const std::string& name) {
+    std::cout << (passed ? "ok     " : "FAILED ") << name << std::endl;
+    return passed;
+}
+
+bool run(const std::string& path) {
+    Client client(path);
+    const Screen zero = glyph({{0xF0, 0x90, 0x90, 0x90, 0xF0}});
+    const Screen five = glyph({{0xF0, 0x80, 0xF0, 0x10, 0xF0}});
+    bool passed = true;
+
+    client.send(Protocol::loadRom, keyRom);
+    passed &= check(client.waitFor([&]() { return client.screen == zero; }), "ROM draws 0");
+
+    client.send(Protocol::key, {5, 1});
+    passed &= check(client.waitFor([&]() { return client.screen == five; }), "key 5 redraws the changed rows");
+    client.send(Protocol::key, {5, 0});
+
+    client.send(Protocol::loadRom, idleRom);
+    passed &= check(client.waitFor([&]() { return client.screen == Screen{}; }), "reload clears the previous screen");
+
+    client.send(Protocol::loadRom, returnRom);
+    passed &= check(client.waitFor([&]() { return !client.error.empty(); }), "return with an empty stack stops the session");
+    return passed;
+}
+
+}
+
+int main() {
+    SessionServer::Options options;
+    options.unixPath = "/tmp/chip8-check-" + std::to_string(getpid()) + ".sock";
+    options.rle = true;
+    options.statsInterval = 0;
+
+    try {
+        SessionServer server(options);
+        std::thread serving(&SessionServer::run, &server);
+        bool passed = false;
+        try {
+            passed = run(options.unixPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error checking the server, Error : " << e.what() << std::endl;
+        }
+        server.stop();
+        serving.join();
+        return passed ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error running the server, Error : " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,72 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "SessionServer.hpp"
+
+namespace {
+
+SessionServer* server = nullptr;
+
+void onSignal(int) {
+    if (server != nullptr)
+        server->stop();
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage : " << program << " [options]\n"
+              << "  -u <path>     listen on a Unix socket\n"
+              << "  -p <port>     listen on TCP 127.0.0.1:port when no Unix socket is given (default : 6464)\n"
+              << "  -j <threads>  event loops sharing the sessions (default : 1)\n"
+              << "  -c <cycles>   cycles emulated per frame (default : 16)\n"
+              << "  -f <fps>      frames per second (default : 60)\n"
+              << "  -z            compress screen updates with RLE when it makes them smaller\n"
+              << "  -i <seconds>  seconds between statistics, 0 disables them (default : 5)\n"
+              << "The protocol is described in Protocol.hpp.\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    SessionServer::Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-z") {
+            options.rle = true;
+        }
+        else if (arg.size() == 2 && arg[0] == '-' && i + 1 < argc) {
+            const char* value = argv[++i];
+            switch (arg[1]) {
+            case 'u': options.unixPath = value; break;
+            case 'p': options.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10)); break;
+            case 'j': options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 'c': options.cyclesPerFrame = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 'f': options.framesPerSecond = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            case 'i': options.statsInterval = static_cast<unsigned>(std::strtoul(value, nullptr, 10)); break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        SessionServer sessionServer(options);
+        server = &sessionServer;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::cout << "Listening on " << (options.unixPath.empty() ? "127.0.0.1:" + std::to_string(options.port) : options.unixPath)
+                  << std::endl;
+        sessionServer.run();
+        server = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error running the server, Error : " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}